@@ -1,6 +1,6 @@
 struct VSInput
 {
-	float4 Position : POSITION;
+	float3 Position : POSITION;
 	float4 Color : COLOR;
 };
 
@@ -13,7 +13,7 @@ struct VSOutput {
 VSOutput main(VSInput In)
 {
 	VSOutput result = (VSOutput)0;
-	result.Position = In.Position;
+	result.Position = float4(In.Position, 1.0);
 	result.Color = In.Color;
 	return result;
 }
\ No newline at end of file
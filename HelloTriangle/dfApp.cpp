@@ -9,8 +9,8 @@ void dfApp::Setup() {
 	uint32_t indices[] = { 0, 1, 2 };
 
 	// Create index buffer and vertex buffer.
-	m_vertexBuffer = CreateBuffer(sizeof(vertices), vertices);
-	m_indexBuffer = CreateBuffer(sizeof(indices), indices);
+	m_vertexBuffer = CreateStaticBuffer(sizeof(vertices), vertices, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, m_vertexBufferAllocation);
+	m_indexBuffer = CreateStaticBuffer(sizeof(indices), indices, D3D12_RESOURCE_STATE_INDEX_BUFFER, m_indexBufferAllocation);
 	m_indexCount = _countof(indices);
 
 	// Create views of each buffer.
@@ -26,28 +26,16 @@ void dfApp::Setup() {
 	hr = m_shader.loadShader(L"VertexShader.hlsl", L"PixelShader.hlsl");
 	Util::CheckResult(hr, "loadShader");
 
-	// Construction of root signature.
-	CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc{};
-	rootSigDesc.Init(
-		0, nullptr,
-		0, nullptr,
-		D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT
-	);
+	// Generate the root signature and the input layout from the shaders.
+	ShaderLayout layout;
+	m_shaderReflector.Reflect({ m_shader.vs.Get(), m_shader.ps.Get() }, layout);
 	ComPtr<ID3DBlob> signature;
-	hr = D3D12SerializeRootSignature(&rootSigDesc, D3D_ROOT_SIGNATURE_VERSION_1_0, &signature, &m_shader.errBlob);
-	Util::CheckResult(hr, "D3D12SerializeRootSignature");
-
-	// Create root signature.
-	hr = m_device->CreateRootSignature(
-		0, signature->GetBufferPointer(), signature->GetBufferSize(),
-		IID_PPV_ARGS(&m_rootSignature)
-	);
+	hr = layout.SerializeRootSignature(signature);
+	if (SUCCEEDED(hr))
+		hr = m_pipelineCache.CreateRootSignature(signature.Get(), m_rootSignature);
 	Util::CheckResult(hr, "CreateRootSignature");
 
-	D3D12_INPUT_ELEMENT_DESC inputElementDesc[] = {
-		{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, offsetof(Vertex, Pos), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA},
-		{"COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, offsetof(Vertex, Color), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA}
-	};
+	auto inputElementDesc = layout.GetInputLayout();
 
 	// Create pipeline state object.
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc{};
@@ -63,7 +51,7 @@ void dfApp::Setup() {
 	psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
 	// Setting of depth buffer format.
 	psoDesc.DSVFormat = DXGI_FORMAT_R32_FLOAT;
-	psoDesc.InputLayout = { inputElementDesc, _countof(inputElementDesc) };
+	psoDesc.InputLayout = { inputElementDesc.data(), UINT(inputElementDesc.size()) };
 	psoDesc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
 	// Set the root signature.
 	psoDesc.pRootSignature = m_rootSignature.Get();
@@ -72,18 +60,15 @@ void dfApp::Setup() {
 	psoDesc.SampleDesc = { 1, 0 };
 	psoDesc.SampleMask = UINT_MAX;
 
-	hr = m_device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_pipeline));
+	hr = m_pipelineCache.CreateGraphicsPipelineState(psoDesc, m_pipeline);
 	Util::CheckResult(hr, "CreateGraphicsPipelineState.");
 }
 
 void dfApp::Cleanup()
 {
-	auto index = m_swapChain->GetCurrentBackBufferIndex();
-	auto fence = m_frameFences[index];
-	auto value = ++m_frameFenceValues[index];
-	m_commandQueue->Signal(fence.Get(), value);
-	fence->SetEventOnCompletion(value, m_fenceWaitEvent);
-	WaitForSingleObject(m_fenceWaitEvent, GpuWaitTimeout);
+	WaitForGpu();
+	ReleasePlacedResource(m_vertexBuffer, m_vertexBufferAllocation);
+	ReleasePlacedResource(m_indexBuffer, m_indexBufferAllocation);
 }
 
 void dfApp::MakeCommand(ComPtr<ID3D12GraphicsCommandList>& command)
@@ -21,8 +21,10 @@ public:
 private:
 	//ComPtr<ID3D12Resource> CreateBuffer(UINT bufferSize, const void* initialData);
 
-	ComPtr<ID3D12Resource> m_vertexBuffer;
-	ComPtr<ID3D12Resource> m_indexBuffer;
+	ComPtr<ID3D12Resource1> m_vertexBuffer;
+	ComPtr<ID3D12Resource1> m_indexBuffer;
+	HeapAllocation m_vertexBufferAllocation;
+	HeapAllocation m_indexBufferAllocation;
 	D3D12_VERTEX_BUFFER_VIEW m_vertexBufferView;
 	D3D12_INDEX_BUFFER_VIEW m_indexBufferView;
 	UINT m_indexCount;
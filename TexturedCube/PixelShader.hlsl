@@ -7,7 +7,25 @@ struct VSOutput {
 Texture2D tex : register(t0);
 SamplerState samp : register(s0);
 
+// Material of the draw. A root constant written per draw by the indirect commands.
+cbuffer DrawConstants : register(b0)
+{
+	uint MaterialIndex;
+};
+
+static const float4 MaterialTints[4] = {
+	float4(1.0, 1.0, 1.0, 1.0),
+	float4(1.0, 0.6, 0.6, 1.0),
+	float4(0.6, 1.0, 0.6, 1.0),
+	float4(0.6, 0.6, 1.0, 1.0),
+};
+
 float4 main(VSOutput In) : SV_TARGET
 {
-	return In.Color * tex.Sample(samp, In.UV);
+	float4 color = tex.Sample(samp, In.UV);
+#if USE_VERTEX_COLOR
+	color *= In.Color;
+#endif
+	color *= MaterialTints[MaterialIndex % 4];
+	return color;
 }
\ No newline at end of file
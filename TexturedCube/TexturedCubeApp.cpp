@@ -1,4 +1,5 @@
 #include <stdexcept>
+#include <thread>
 #include "TexturedCubeApp.h"
 #include <DirectXTex/DirectXTex.h>
 #pragma comment(lib, "DirectXTex.lib")
@@ -12,7 +13,9 @@
 
 
 
-void TexturedCubeApp::Prepare() {
+void TexturedCubeApp::Setup() {
+    using namespace DirectX;
+
     const float k = 1.0f;
     const Vector4 red(1.0f, 0.0f, 0.0f, 1.0f);
     const Vector4 green(0.0f, 1.0f, 0.0f, 1.0f);
@@ -66,8 +69,8 @@ void TexturedCubeApp::Prepare() {
     };
 
     // Create vertex buffer and index buffer.
-    m_vertexBuffer = CreateBuffer(sizeof(triangleVertices), triangleVertices);
-    m_indexBuffer = CreateBuffer(sizeof(indices), indices);
+    m_vertexBuffer = CreateStaticBuffer(sizeof(triangleVertices), triangleVertices, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, m_vertexBufferAllocation);
+    m_indexBuffer = CreateStaticBuffer(sizeof(indices), indices, D3D12_RESOURCE_STATE_INDEX_BUFFER, m_indexBufferAllocation);
     m_indexCount = _countof(indices);
 
     // Create views of each buffer.
@@ -77,60 +80,71 @@ void TexturedCubeApp::Prepare() {
     m_indexBufferView.BufferLocation = m_indexBuffer->GetGPUVirtualAddress();
     m_indexBufferView.SizeInBytes = sizeof(indices);
     m_indexBufferView.Format = DXGI_FORMAT_R32_UINT;
+    m_cubeMesh = m_instances.AddMesh({ m_vertexBufferView, m_indexBufferView, m_indexCount });
 
-    // Compile shader.
-    HRESULT hr;
-    ComPtr<ID3DBlob> errBlob;
-    hr = CompileShaderFromFile(L"VertexShader.hlsl", L"vs_6_0", m_vs, errBlob);
-    if (FAILED(hr))
+    // Place the cubes of the grid.
+    const auto mtxRotation = XMMatrixRotationAxis(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), XMConvertToRadians(45.0f));
+    const float spacing = 3.0f;
+    const float origin = -0.5f * spacing * float(CubeGridSize - 1);
+    for (UINT z = 0; z < CubeGridSize; z++)
     {
-        OutputDebugStringA((const char*)errBlob->GetBufferPointer());
+        for (UINT y = 0; y < CubeGridSize; y++)
+        {
+            for (UINT x = 0; x < CubeGridSize; x++)
+            {
+                Matrix4x4 world;
+                auto mtxTranslation = XMMatrixTranslation(origin + spacing * x, origin + spacing * y, origin + spacing * z);
+                XMStoreFloat4x4(&world, mtxRotation * mtxTranslation);
+                m_cubeWorlds.push_back(world);
+                m_cubeMaterials.push_back((x + y + z) % MaterialCount);
+            }
+        }
     }
-    hr = CompileShaderFromFile(L"PixelShader.hlsl", L"ps_6_0", m_ps, errBlob);
-    if (FAILED(hr))
+    m_cubeWVPs.resize(m_cubeWorlds.size());
+
+    // Compile shaders in parallel. Both variants of the pixel shader are compiled,
+    // so switching the feature later doesn't stall on the compiler.
+    HRESULT hr;
+    auto vertexShader = m_shaderCompileService.Submit({ L"VertexShader.hlsl", L"main", L"vs_6_0" });
+    m_pixelShaders = std::make_unique<ShaderPermutations>(
+        &m_shaderCompileService, L"PixelShader.hlsl", L"main", L"ps_6_0", std::vector<std::wstring>{ L"USE_VERTEX_COLOR" });
+    const auto vertexColorBit = m_pixelShaders->GetFeatureBit(L"USE_VERTEX_COLOR");
+    m_pixelShaders->Precompile({ 0, vertexColorBit });
+    m_ps = m_pixelShaders->Get(UseVertexColor ? vertexColorBit : 0);
+    m_pixelShaders->ReportStats();
+
+    auto result = vertexShader.get();
+    if (FAILED(result.hr))
     {
-        OutputDebugStringA((const char*)errBlob->GetBufferPointer());
+        OutputDebugStringA((const char*)result.error->GetBufferPointer());
     }
+    m_vs = result.shader;
 
-    CD3DX12_DESCRIPTOR_RANGE cbv, srv, sampler;
-    cbv.Init(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 0); // b0 Register.
-    srv.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0); // t0 Register.
-    sampler.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER, 1, 0); // s0 Register.
-
-    CD3DX12_ROOT_PARAMETER rootParams[3];
-    rootParams[0].InitAsDescriptorTable(1, &cbv, D3D12_SHADER_VISIBILITY_VERTEX);
-    rootParams[1].InitAsDescriptorTable(1, &srv, D3D12_SHADER_VISIBILITY_PIXEL);
-    rootParams[2].InitAsDescriptorTable(1, &sampler, D3D12_SHADER_VISIBILITY_PIXEL);
-
-    CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc{};
-    rootSigDesc.Init(
-        _countof(rootParams), rootParams, // pParameters
-        0, nullptr, // pStaticSamplers.
-        D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT
-    );
+    // Generate the root signature and the input layout from the shaders.
+    ShaderLayout layout;
+    m_shaderReflector.Reflect({ m_vs.Get(), m_ps.Get() }, layout);
     ComPtr<ID3DBlob> signature;
-    hr = D3D12SerializeRootSignature(&rootSigDesc, D3D_ROOT_SIGNATURE_VERSION_1_0, &signature, &errBlob);
+    hr = layout.SerializeRootSignature(signature);
+    if (SUCCEEDED(hr))
+        hr = m_pipelineCache.CreateRootSignature(signature.Get(), m_rootSignature);
     if (FAILED(hr))
     {
-        throw std::runtime_error("D3D12SerializeRootSignature failed.");
+        throw std::runtime_error("CreateRootSignature failed.");
     }
-    // Create rootSignature.
-    hr = m_device->CreateRootSignature(
-        0,
-        signature->GetBufferPointer(), signature->GetBufferSize(),
-        IID_PPV_ARGS(&m_rootSignature)
-    );
-    if (FAILED(hr))
+    m_paramTexture = layout.GetParameter("tex");
+    m_paramSampler = layout.GetParameter("samp");
+
+    // The material of each draw is a root constant, which the indirect commands set per draw.
+    // The command signature changes a root argument, so it needs the root signature.
+    m_instances.SetMaterialConstant(layout.GetParameter("DrawConstants"));
+    if (FAILED(m_instances.GetIndirectLayout().CreateCommandSignature(m_device.Get(), m_rootSignature.Get(), m_drawSignature)))
     {
-        throw std::runtime_error("CreateRootSignature failed.");
+        throw std::runtime_error("CreateCommandSignature failed.");
     }
 
-    // Input layout. 
-    D3D12_INPUT_ELEMENT_DESC inputElementDesc[] = {
-        {"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, offsetof(Vertex, Pos), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA},
-        {"COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, offsetof(Vertex, Color), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA},
-        {"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, offsetof(Vertex, UV), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA}
-    };
+    // Input layout. The elements are packed in the order of VSInput, which matches Vertex,
+    // and the INSTANCE_ elements are read from the instance stream.
+    auto inputElementDesc = layout.GetInputLayout();
 
     // Create pipeline state object.
     D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc{};
@@ -148,7 +162,7 @@ void TexturedCubeApp::Prepare() {
     psoDesc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
     psoDesc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
 
-    psoDesc.InputLayout = { inputElementDesc, _countof(inputElementDesc) };
+    psoDesc.InputLayout = { inputElementDesc.data(), UINT(inputElementDesc.size()) };
 
     // Set the root signature.
     psoDesc.pRootSignature = m_rootSignature.Get();
@@ -157,29 +171,8 @@ void TexturedCubeApp::Prepare() {
     psoDesc.SampleDesc = { 1, 0 };
     psoDesc.SampleMask = UINT_MAX; 
 
-    hr = m_device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_pipeline));
-    if (FAILED(hr))
-    {
-        throw std::runtime_error("CreateGraphicsPipelineState failed.");
-    }
-
-    PrepareDescriptorHeapForTexturedCubeApp();
-
-    // Create constant buffer / constant buffer view. 
-    m_constantBuffers.resize(FrameBufferCount);
-    m_cbViews.resize(FrameBufferCount);
-    for (UINT i = 0; i < FrameBufferCount; i++) {
-        UINT bufferSize = sizeof(ShaderParameters) + 255 & ~255;
-        m_constantBuffers[i] = CreateBuffer(bufferSize, nullptr);
-
-        D3D12_CONSTANT_BUFFER_VIEW_DESC cbDesc{};
-        cbDesc.BufferLocation = m_constantBuffers[i]->GetGPUVirtualAddress();
-        cbDesc.SizeInBytes = bufferSize;
-        CD3DX12_CPU_DESCRIPTOR_HANDLE handleCBV(m_heapSrvCbv->GetCPUDescriptorHandleForHeapStart(), ConstantBufferDescriptorBase + i, m_srvcbvDescriptorSize);
-        m_device->CreateConstantBufferView(&cbDesc, handleCBV);
-
-        m_cbViews[i] = CD3DX12_GPU_DESCRIPTOR_HANDLE(m_heapSrvCbv->GetGPUDescriptorHandleForHeapStart(), ConstantBufferDescriptorBase + i, m_srvcbvDescriptorSize);
-    }
+    // Compiled in background. The cube is not drawn until the pipeline is ready.
+    m_pipeline = m_pipelineCompileQueue.Submit(psoDesc);
 
     // Create texture.
     m_texture = DXCreateTexture(L"normal.png");
@@ -202,13 +195,13 @@ void TexturedCubeApp::Prepare() {
     samplerDesc.MipLODBias = 0.0f;
     samplerDesc.MaxAnisotropy = 0;
 
-    // Use 0 index of descriptor heap for sampler.
-    auto descriptorSampler = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_heapSampler->GetCPUDescriptorHandleForHeapStart(), SamplerDescriptorBase, m_samplerDescriptorSize);
-    m_device->CreateSampler(&samplerDesc, descriptorSampler);
-    m_sampler = CD3DX12_GPU_DESCRIPTOR_HANDLE(m_heapSampler->GetGPUDescriptorHandleForHeapStart(), SamplerDescriptorBase, m_samplerDescriptorSize);
+    // The sampler is created in CPU only heap as well as the view.
+    m_sampler = m_descriptorAllocators[D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER].Allocate();
+    m_device->CreateSampler(&samplerDesc, m_sampler.cpu);
 
     // Prepare shader resource view from texture.
-    auto srvHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_heapSrvCbv->GetCPUDescriptorHandleForHeapStart(), TextureSrvDescriptorBase, m_srvcbvDescriptorSize);
+    // The view is created in CPU only heap, and copied to the shader visible heap when drawing.
+    m_textureSrv = m_descriptorAllocators[D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV].Allocate();
     D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
     D3D12_RESOURCE_DESC textureDesc = m_texture->GetDesc();
     srvDesc.Texture2D.MipLevels = 1;
@@ -220,99 +213,91 @@ void TexturedCubeApp::Prepare() {
     srvDesc.Texture2D.PlaneSlice = 0;
     srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
     srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-    m_device->CreateShaderResourceView(m_texture.Get(), &srvDesc, 
-        m_heapSrvCbv->GetCPUDescriptorHandleForHeapStart());
-    m_srv = CD3DX12_GPU_DESCRIPTOR_HANDLE(m_heapSrvCbv->GetGPUDescriptorHandleForHeapStart(), TextureSrvDescriptorBase, m_srvcbvDescriptorSize);
+    m_device->CreateShaderResourceView(m_texture.Get(), &srvDesc, m_textureSrv.cpu);
 }
 
 void TexturedCubeApp::Cleanup() {
-    auto index = m_swapChain->GetCurrentBackBufferIndex();
-    auto fence = m_frameFences[index];
-    auto value = ++m_frameFenceValues[index];
-    m_commandQueue->Signal(fence.Get(), value);
-    fence->SetEventOnCompletion(value, m_fenceWaitEvent);
-    WaitForSingleObject(m_fenceWaitEvent, GpuWaitTimeout);
+    WaitForGpu();
+    ReleasePlacedResource(m_vertexBuffer, m_vertexBufferAllocation);
+    ReleasePlacedResource(m_indexBuffer, m_indexBufferAllocation);
 }
 
 void TexturedCubeApp::MakeCommand(ComPtr<ID3D12GraphicsCommandList>& command) {
     using namespace DirectX;
 
+    // Skip the draw while the pipeline is compiling.
+    auto pipeline = m_pipeline.Get();
+    if (pipeline == nullptr)
+    {
+        if (m_pipeline.IsFailed())
+            throw std::runtime_error("CreateGraphicsPipelineState failed.");
+        return;
+    }
+
     // Set each matrices.
-    ShaderParameters shaderParams;
-    XMStoreFloat4x4(&shaderParams.mtxWorld, XMMatrixRotationAxis(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), XMConvertToRadians(45.0f)));
     auto mtxView = XMMatrixLookAtLH(
         XMVectorSet(0.0f, 3.0f, -5.0f, 0.0f),
         XMVectorSet(0.0f, 0.0f, 0.0f, 0.0f),
         XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)
     );
     auto mtxProj = XMMatrixPerspectiveFovLH(XMConvertToRadians(45.0f), m_viewport.Width / m_viewport.Height, 0.1f, 100.0f);
-    XMStoreFloat4x4(&shaderParams.mtxView, XMMatrixTranspose(mtxView));
-    XMStoreFloat4x4(&shaderParams.mtxProj, XMMatrixTranspose(mtxProj));
 
-    // Update constant buffer.
-    auto& constantBuffer = m_constantBuffers[m_frameIndex];
+    // World-view-projection of every cube at once, so the vertex shader does a single transform.
+    MultiplyMatrices(m_cubeWorlds.data(), m_cubeWorlds.size(), XMMatrixMultiply(mtxView, mtxProj), m_cubeWVPs.data());
+
+    // Sort the cubes of the grid by their sort keys. The w of the clip space origin is the view depth,
+    // so cubes are grouped by material and come front to back in it, and the depth test rejects more of the far ones.
+    m_renderQueue.Clear();
+    m_renderQueue.Reserve(m_cubeWVPs.size());
+    for (UINT i = 0; i < UINT(m_cubeWVPs.size()); i++)
+    {
+        m_renderQueue.Push(RenderSortKey::MakeOpaque(0, 0, m_cubeMaterials[i], m_cubeWVPs[i]._44), i);
+    }
+    m_renderQueue.Sort(std::thread::hardware_concurrency());
+
+    // They share the mesh, so they go in one batch per material in the sorted order.
+    m_instances.Clear();
+    m_renderQueue.Submit([&](uint64_t key, UINT cube) {
+        m_instances.Add(m_cubeMesh, RenderSortKey::GetOpaqueMaterial(key), { m_cubeWVPs[cube] });
+    });
+    if (!m_instances.Upload(m_uploadRing))
     {
-        void* p;
-        CD3DX12_RANGE range(0, 0);
-        constantBuffer->Map(0, &range, &p);
-        memcpy(p, &shaderParams, sizeof(shaderParams));
-        constantBuffer->Unmap(0, nullptr);
+        throw std::runtime_error("Upload ring is full.");
     }
 
     // Set the pipeline state.
-    command->SetPipelineState(m_pipeline.Get());
+    m_stateCommandList.SetPipelineState(pipeline);
     // Set the root signature.
-    command->SetGraphicsRootSignature(m_rootSignature.Get());
+    m_stateCommandList.SetGraphicsRootSignature(m_rootSignature.Get());
     // Set the viewport and scissor.
-    command->RSSetViewports(1, &m_viewport);
-    command->RSSetScissorRects(1, &m_scissorRect);
-
-    // Set the descriptor heap.
-    ID3D12DescriptorHeap* heaps[] = {
-        m_heapSrvCbv.Get(), m_heapSampler.Get()
-    };
-    command->SetDescriptorHeaps(_countof(heaps), heaps);
-
-    // Set the primitive type, vertex, index buffers.
-    command->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    command->IASetVertexBuffers(0, 1, &m_vertexBufferView);
-    command->IASetIndexBuffer(&m_indexBufferView);
-
-    command->SetGraphicsRootDescriptorTable(0, m_cbViews[m_frameIndex]);
-    command->SetGraphicsRootDescriptorTable(1, m_srv);
-    command->SetGraphicsRootDescriptorTable(2, m_sampler);
-
-    // Make rendering order.
-    command->DrawIndexedInstanced(m_indexCount, 1, 0, 0, 0);
-}
+    m_stateCommandList.RSSetViewports(1, &m_viewport);
+    m_stateCommandList.RSSetScissorRects(1, &m_scissorRect);
+
+    // Build the descriptor tables of this draw in the shader visible rings.
+    // The heaps of the rings have already been set for the frame.
+    DescriptorTable srvTable, samplerTable;
+    if (!m_descriptorRing.AllocateTable(&m_textureSrv.cpu, 1, srvTable) ||
+        !m_samplerRing.AllocateTable(&m_sampler.cpu, 1, samplerTable))
+    {
+        throw std::runtime_error("Descriptor ring is full.");
+    }
 
-TexturedCubeApp::ComPtr<ID3D12Resource1> TexturedCubeApp::CreateBuffer(UINT bufferSize, const void* initialData)
-{
-    HRESULT hr;
-    ComPtr<ID3D12Resource1> buffer;
-    hr = m_device->CreateCommittedResource(
-        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
-        D3D12_HEAP_FLAG_NONE,
-        &CD3DX12_RESOURCE_DESC::Buffer(bufferSize),
-        D3D12_RESOURCE_STATE_GENERIC_READ,
-        nullptr,
-        IID_PPV_ARGS(&buffer)
-    );
+    // Set the primitive type. Vertex and index buffers are set per batch.
+    m_stateCommandList.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
-    // Make copy if there is specification of initial data.
-    if (SUCCEEDED(hr) && initialData != nullptr)
+    // Make rendering order. One draw per mesh and material.
+    auto setMaterial = [&](UINT material) {
+        m_stateCommandList.SetGraphicsRootDescriptorTable(m_paramTexture, srvTable.gpu);
+        m_stateCommandList.SetGraphicsRootDescriptorTable(m_paramSampler, samplerTable.gpu);
+    };
+    if (!UseExecuteIndirect)
     {
-        void* mapped;
-        CD3DX12_RANGE range(0, 0);
-        hr = buffer->Map(0, &range, &mapped);
-        if (SUCCEEDED(hr))
-        {
-            memcpy(mapped, initialData, bufferSize);
-            buffer->Unmap(0, nullptr);
-        }
+        m_instances.Draw(m_stateCommandList, setMaterial);
+    }
+    else if (!m_instances.DrawIndirect(m_stateCommandList, m_uploadRing, m_drawSignature.Get(), setMaterial))
+    {
+        throw std::runtime_error("Upload ring is full.");
     }
-
-    return buffer;
 }
 
 TexturedCubeApp::ComPtr<ID3D12Resource> TexturedCubeApp::DXCreateTexture(const std::wstring& fileName)
@@ -322,7 +307,6 @@ TexturedCubeApp::ComPtr<ID3D12Resource> TexturedCubeApp::DXCreateTexture(const s
     if (FAILED(hr))
         throw std::runtime_error("Faileed CoInitlializeEx.");
     
-    ComPtr<ID3D12Resource> textureUploadHeap;
     ComPtr<ID3D12Resource> texture;
 
     // Create texture from WIC.
@@ -337,36 +321,9 @@ TexturedCubeApp::ComPtr<ID3D12Resource> TexturedCubeApp::DXCreateTexture(const s
         if (FAILED(hr))
             throw std::runtime_error("Failed LoadWICTextureFromFile.");
 
-        const UINT64 uploadBufferSize = GetRequiredIntermediateSize(texture.Get(), 0, 1);
-
-        // Create the GPU upload buffer.
-        hr = m_device->CreateCommittedResource(
-            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
-            D3D12_HEAP_FLAG_NONE,
-            &CD3DX12_RESOURCE_DESC::Buffer(uploadBufferSize),
-            D3D12_RESOURCE_STATE_GENERIC_READ,
-            nullptr,
-            IID_PPV_ARGS(&textureUploadHeap)
-        );
-        if (FAILED(hr))
-            throw std::runtime_error("Failed CreateCommittedResource.");
-
-        UpdateSubresources(m_commandList.Get(),
-            texture.Get(),
-            textureUploadHeap.Get(),
-            0,
-            0,
-            1,
-            &subresourceData);
-        // Finally, set the resource barrier.
-        auto barrierTex = CD3DX12_RESOURCE_BARRIER::Transition(
-            texture.Get(),
-            D3D12_RESOURCE_STATE_COPY_DEST,
-            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE
-        );
-
-        m_commandList->ResourceBarrier(1, &barrierTex);
-        m_commandList->Close();
+        // The texture is created in COPY_DEST state. The uploader copies the decoded data
+        // into its staging memory, which is released when the copy has been completed on GPU.
+        m_textureUploader.Enqueue(texture.Get(), 0, 1, &subresourceData, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
     }
     return texture;
 }
@@ -460,7 +417,7 @@ TexturedCubeApp::ComPtr<ID3D12Resource1> TexturedCubeApp::CreateTexture(const st
 {
     ComPtr<ID3D12Resource1> texture;
     int texWidth = 0, texHeight = 0, channels = 0;
-    auto* pImage = stbi_load(fileName.c_str(), &texWidth, &texHeight, &channels, 0);
+    auto* pImage = stbi_load(fileName.c_str(), &texWidth, &texHeight, &channels, STBI_rgb_alpha);
 
     // Prepare the Desc of texture resourec from size and format.
     auto texDesc = CD3DX12_RESOURCE_DESC::Tex2D(
@@ -480,92 +437,14 @@ TexturedCubeApp::ComPtr<ID3D12Resource1> TexturedCubeApp::CreateTexture(const st
         IID_PPV_ARGS(&texture)
     );
 
-    D3D12_PLACED_SUBRESOURCE_FOOTPRINT layouts;
-    UINT numRows;
-    UINT64 rowSizeBytes, totalBytes;
-    m_device->GetCopyableFootprints(&texDesc, 0, 1, 0, &layouts, &numRows, &rowSizeBytes, &totalBytes);
-    ComPtr<ID3D12Resource1> stagingBuffer = CreateBuffer(totalBytes, nullptr);
-
-    // Copy the image to staging buffer.
-    {
-        const UINT imagePitch = texWidth * sizeof(uint32_t);
-        void* pBuf;
-        CD3DX12_RANGE range(0, 0);
-        stagingBuffer->Map(0, &range, &pBuf);
-        for (UINT h = 0; h < numRows; h++)
-        {
-            auto dst = static_cast<char*>(pBuf) + h * rowSizeBytes;
-            auto src = pImage + h * imagePitch;
-            memcpy(dst, src, imagePitch);
-        }
-    }
-
-    // Prepare the command.
-    ComPtr<ID3D12GraphicsCommandList> command;
-    m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_commandAllocators[m_frameIndex].Get(), nullptr, IID_PPV_ARGS(&command));
-    ComPtr<ID3D12Fence1> fence;
-    m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence));
-
-    // Transferring command.
-    D3D12_TEXTURE_COPY_LOCATION src{}, dst{};
-    dst.pResource = texture.Get();
-    dst.SubresourceIndex = 0;
-    dst.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
-
-    src.pResource = stagingBuffer.Get();
-    src.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
-    src.PlacedFootprint = layouts;
-    command->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
-
-    // Go to next state after copied.
-    auto barrierTex = CD3DX12_RESOURCE_BARRIER::Transition(
-        texture.Get(),
-        D3D12_RESOURCE_STATE_COPY_DEST,
-        D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE
-    );
-    command->ResourceBarrier(1, &barrierTex);
-
-    command->Close();
-
-    // Execute the command.
-    ID3D12CommandList* cmds[] = { command.Get() };
-    m_commandQueue->ExecuteCommandLists(1, cmds);
-    // Arise the signal after executed.
-    const UINT64 expected = 1;
-    m_commandQueue->Signal(fence.Get(), expected);
-
-    // Wait to finish processing texture.
-    while (expected != fence->GetCompletedValue())
-    {
-        Sleep(1);
-    }
+    // The copy is batched with other textures and submitted before the next frame.
+    // The image is copied to staging memory here, so it can be freed immediately.
+    D3D12_SUBRESOURCE_DATA subresourceData{};
+    subresourceData.pData = pImage;
+    subresourceData.RowPitch = LONG_PTR(texWidth) * sizeof(uint32_t);
+    subresourceData.SlicePitch = subresourceData.RowPitch * texHeight;
+    m_textureUploader.Enqueue(texture.Get(), 0, 1, &subresourceData, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 
     stbi_image_free(pImage);
     return texture;
-}
-
-void TexturedCubeApp::PrepareDescriptorHeapForTexturedCubeApp()
-{
-    // Descriptor heap of CBV/SRV.
-    // 0: Shader resource view.
-    // 1, 2: Constance buffer view.
-    UINT count = FrameBufferCount + 1;
-    D3D12_DESCRIPTOR_HEAP_DESC srvHeapDesc{
-        D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
-        count,
-        D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE,
-        0
-    };
-    m_device->CreateDescriptorHeap(&srvHeapDesc, IID_PPV_ARGS(&m_heapSrvCbv));
-    m_srvcbvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-
-    // Descriptor heap of dynamic sampler.
-    D3D12_DESCRIPTOR_HEAP_DESC samplerHeapDesc{
-        D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER,
-        1,
-        D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE,
-        0
-    };
-    m_device->CreateDescriptorHeap(&samplerHeapDesc, IID_PPV_ARGS(&m_heapSampler));
-    m_samplerDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER);
 }
\ No newline at end of file
@@ -2,12 +2,20 @@
 
 #include "../util/D3D12AppBase.h"
 #include "../util/mathutil.h"
+#include "../util/InstanceBatcher.h"
+#include "../util/RenderQueue.h"
+#include "../util/ShaderPermutations.h"
+#include <memory>
 
 class TexturedCubeApp : public D3D12AppBase {
 public:
-    TexturedCubeApp() : D3D12AppBase() {};
+    TexturedCubeApp() : D3D12AppBase()
+    {
+        // The instance stream of the grid and the indirect arguments, with some room for the alignments.
+        SetUploadBytesPerFrame(UINT64(CubeGridSize) * CubeGridSize * CubeGridSize * sizeof(InstanceData) + 64 * 1024);
+    };
 
-    virtual void Prepare() override;
+    virtual void Setup() override;
     virtual void Cleanup() override;
     virtual void MakeCommand(ComPtr<ID3D12GraphicsCommandList>& command) override;
 
@@ -17,45 +25,55 @@ public:
         Vector2 UV;
     };
 
-    struct ShaderParameters
+    // Per-instance stream, matches the INSTANCE_ inputs of VertexShader.hlsl.
+    // The matrices are multiplied on CPU once per object instead of per vertex.
+    // A shader which lights in world space would take the world matrix here as well.
+    struct InstanceData
     {
-        Matrix4x4 mtxWorld;
-        Matrix4x4 mtxView;
-        Matrix4x4 mtxProj;
+        Matrix4x4 mtxWVP;
     };
 
-
-    enum {
-        TextureSrvDescriptorBase = 0,
-        ConstantBufferDescriptorBase = 1,
-        // Since sampler is in other heap, use head index.
-        SamplerDescriptorBase = 0,
-    };
+    // Cubes per axis of the grid. They are drawn with one draw whatever the count, e.g. 47 gives about 100k cubes.
+    // The upload ring is sized from it, about 6.6MB of instance data per frame for 47.
+    static const UINT CubeGridSize = 1;
+    // Materials given to the cubes of the grid in turn. They tint the texture in the pixel shader.
+    static const UINT MaterialCount = 4;
+    // Submit the batches with ExecuteIndirect instead of one DrawIndexedInstanced each.
+    static const bool UseExecuteIndirect = true;
+    // Tint the texture with the vertex colors. Selects the USE_VERTEX_COLOR variant of the pixel shader.
+    static const bool UseVertexColor = true;
 
 private:
-    ComPtr<ID3D12Resource1> CreateBuffer(UINT bufferSize, const void* initialData);
     ComPtr<ID3D12Resource1> CreateTexture(const std::string& fileName);
     ComPtr<ID3D12Resource> DXCreateTexture(const std::wstring& fileName);
-    void PrepareDescriptorHeapForTexturedCubeApp();
-
-    ComPtr<ID3D12DescriptorHeap> m_heapSrvCbv;
-    ComPtr<ID3D12DescriptorHeap> m_heapSampler;
-    UINT m_samplerDescriptorSize;
 
     ComPtr<ID3D12Resource1> m_vertexBuffer;
     ComPtr<ID3D12Resource1> m_indexBuffer;
+    HeapAllocation m_vertexBufferAllocation;
+    HeapAllocation m_indexBufferAllocation;
     ComPtr<ID3D12Resource> m_texture; 
     D3D12_VERTEX_BUFFER_VIEW m_vertexBufferView;
     D3D12_INDEX_BUFFER_VIEW m_indexBufferView;
     UINT m_indexCount;
+    InstanceBatcher<InstanceData> m_instances;
+    UINT m_cubeMesh;
+    // World matrices of the cubes, and their world-view-projection of the frame.
+    std::vector<Matrix4x4> m_cubeWorlds;
+    std::vector<Matrix4x4> m_cubeWVPs;
+    std::vector<UINT> m_cubeMaterials;
+    // Cubes of the frame sorted front to back, so the batch fills the instance stream in that order.
+    RenderQueue<UINT> m_renderQueue;
+    ComPtr<ID3D12CommandSignature> m_drawSignature;
 
     ComPtr<ID3DBlob> m_vs, m_ps;
+    std::unique_ptr<ShaderPermutations> m_pixelShaders;
     ComPtr<ID3D12RootSignature> m_rootSignature;
-    ComPtr<ID3D12PipelineState> m_pipeline; 
-
-    std::vector<ComPtr<ID3D12Resource1>> m_constantBuffers;
+    PipelineHandle m_pipeline;
+    // Root parameter indices given by the shader reflection.
+    UINT m_paramTexture;
+    UINT m_paramSampler;
 
-    D3D12_GPU_DESCRIPTOR_HANDLE m_sampler;
-    D3D12_GPU_DESCRIPTOR_HANDLE m_srv;
-    std::vector<D3D12_GPU_DESCRIPTOR_HANDLE> m_cbViews;
+    // CPU only descriptors, copied into the descriptor rings per draw.
+    DescriptorHandle m_sampler;
+    DescriptorHandle m_textureSrv;
 };
\ No newline at end of file
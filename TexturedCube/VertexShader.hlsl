@@ -1,8 +1,13 @@
 struct VSInput
 {
-	float4 Position : POSITION;
+	float3 Position : POSITION;
 	float4 Color : COLOR;
 	float2 UV : TEXCOORD0;
+	// Rows of the world-view-projection matrix premultiplied on CPU, read per instance.
+	float4 WVP0 : INSTANCE_WVP0;
+	float4 WVP1 : INSTANCE_WVP1;
+	float4 WVP2 : INSTANCE_WVP2;
+	float4 WVP3 : INSTANCE_WVP3;
 };
 
 struct VSOutput
@@ -12,17 +17,10 @@ struct VSOutput
 	float2 UV : TEXCOORD0;
 };
 
-cbuffer ShaderParameter : register(b0)
-{
-	float4x4 world;
-	float4x4 view;
-	float4x4 proj;
-}
-
 VSOutput main(VSInput In) {
 	VSOutput result = (VSOutput)0;
-	float4x4 mtxWVP = mul(world, mul(view, proj));
-	result.Position = mul(In.Position, mtxWVP);
+	float4x4 mtxWVP = float4x4(In.WVP0, In.WVP1, In.WVP2, In.WVP3);
+	result.Position = mul(float4(In.Position, 1.0), mtxWVP);
 	result.Color = In.Color;
 	result.UV = In.UV;
 	return result;
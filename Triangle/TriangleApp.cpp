@@ -1,6 +1,15 @@
 #include "TriangleApp.h"
 #include <stdexcept>
 
+const std::vector<ShaderCompileJob>& TriangleApp::GetShaderJobs()
+{
+	static const std::vector<ShaderCompileJob> jobs = {
+		{ L"VertexShader.hlsl", L"main", L"vs_6_0" },
+		{ L"PixelShader.hlsl", L"main", L"ps_6_0" },
+	};
+	return jobs;
+}
+
 void TriangleApp::Setup() {
 	Vertex triangleVertices[] = {
 		{ { 0.0f, 0.25f, 0.5f}, {1.0f, 0.0f, 0.0f, 1.0f}},
@@ -10,8 +19,8 @@ void TriangleApp::Setup() {
 	uint32_t indices[] = { 0, 1, 2 };
 	
 	// Create index buffer and vertex buffer.
-	m_vertexBuffer = CreateBuffer(sizeof(triangleVertices), triangleVertices);
-	m_indexBuffer = CreateBuffer(sizeof(indices), indices);
+	m_vertexBuffer = CreateStaticBuffer(sizeof(triangleVertices), triangleVertices, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, m_vertexBufferAllocation);
+	m_indexBuffer = CreateStaticBuffer(sizeof(indices), indices, D3D12_RESOURCE_STATE_INDEX_BUFFER, m_indexBufferAllocation);
 	m_indexCount = _countof(indices);
 
 	// Create views of each buffer.
@@ -34,43 +43,31 @@ void TriangleApp::Setup() {
 	if (FAILED(hr)) {
 		OutputDebugStringA((const char*)errBlob->GetBufferPointer());
 	}*/
-	hr = m_shader.loadShader(L"VertexShader.hlsl", L"PixelShader.hlsl");
-	Util::CheckResult(hr, "loadShader");
+	// From Shaders.pak when it is up to date with the files.
+	const auto& shaderJobs = GetShaderJobs();
+	LoadShader(shaderJobs[0], m_vs);
+	LoadShader(shaderJobs[1], m_ps);
 
-	// Construction of root signature.
-	CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc{};
-	rootSigDesc.Init(
-		0, nullptr,
-		0, nullptr,
-		D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT
-	);
+	// Generate the root signature and the input layout from the shaders.
+	ShaderLayout layout;
+	m_shaderReflector.Reflect({ m_vs.Get(), m_ps.Get() }, layout);
 	ComPtr<ID3DBlob> signature;
-	hr = D3D12SerializeRootSignature(&rootSigDesc, D3D_ROOT_SIGNATURE_VERSION_1_0, &signature, &m_shader.errBlob);
-	if (FAILED(hr)) {
-		throw std::runtime_error("D3D12SerializeRootSignature failed.");
-	}
-	// Creating root signature.
-	hr = m_device->CreateRootSignature(
-		0,
-		signature->GetBufferPointer(), signature->GetBufferSize(),
-		IID_PPV_ARGS(&m_rootSignature)
-	);
+	hr = layout.SerializeRootSignature(signature);
+	if (SUCCEEDED(hr))
+		hr = m_pipelineCache.CreateRootSignature(signature.Get(), m_rootSignature);
 	if (FAILED(hr))
 	{
 		throw std::runtime_error("CreateRootSignature failed.");
 	}
 
 	// Input rayout.
-	D3D12_INPUT_ELEMENT_DESC inputElementDesc[] = {
-		{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, offsetof(Vertex, Pos), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA},
-		{"COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, offsetof(Vertex, Color), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA},
-	};
+	auto inputElementDesc = layout.GetInputLayout();
 
 	// Create pipeline state object.
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc{};
 	// Set the shader.
-	psoDesc.VS = CD3DX12_SHADER_BYTECODE(m_shader.vs.Get());
-	psoDesc.PS = CD3DX12_SHADER_BYTECODE(m_shader.ps.Get());
+	psoDesc.VS = CD3DX12_SHADER_BYTECODE(m_vs.Get());
+	psoDesc.PS = CD3DX12_SHADER_BYTECODE(m_ps.Get());
 	// Setting of blend state.
 	psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
 	// Setting of rasterizer state.
@@ -80,7 +77,7 @@ void TriangleApp::Setup() {
 	psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
 	// Setting of depth buffer format.
 	psoDesc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
-	psoDesc.InputLayout = {inputElementDesc, _countof(inputElementDesc)};
+	psoDesc.InputLayout = { inputElementDesc.data(), UINT(inputElementDesc.size()) };
 	psoDesc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
 	// Set the root signature.
 	psoDesc.pRootSignature = m_rootSignature.Get();
@@ -89,7 +86,7 @@ void TriangleApp::Setup() {
 	psoDesc.SampleDesc = {1, 0};
 	psoDesc.SampleMask = UINT_MAX; // Important! If I forget this phrase, I cannot display image and obtain warning. 
 
-	hr = m_device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_pipeline));
+	hr = m_pipelineCache.CreateGraphicsPipelineState(psoDesc, m_pipeline);
 	if(FAILED(hr)) {
 		throw std::runtime_error("CreateGraphicsPipelineState failed");
 	}
@@ -97,58 +94,26 @@ void TriangleApp::Setup() {
 
 void TriangleApp::Cleanup()
 {
-	auto index = m_swapChain->GetCurrentBackBufferIndex();
-	auto fence = m_frameFences[index];
-	auto value = ++m_frameFenceValues[index];
-	m_commandQueue->Signal(fence.Get(), value);
-	fence->SetEventOnCompletion(value, m_fenceWaitEvent);
-	WaitForSingleObject(m_fenceWaitEvent, GpuWaitTimeout);
+	WaitForGpu();
+	ReleasePlacedResource(m_vertexBuffer, m_vertexBufferAllocation);
+	ReleasePlacedResource(m_indexBuffer, m_indexBufferAllocation);
 }
 
 void TriangleApp::MakeCommand(ComPtr<ID3D12GraphicsCommandList>& command)
 {
 	// Set the pipeline state.
-	command->SetPipelineState(m_pipeline.Get());
+	m_stateCommandList.SetPipelineState(m_pipeline.Get());
 	// Set the root signature.
-	command->SetGraphicsRootSignature(m_rootSignature.Get());
+	m_stateCommandList.SetGraphicsRootSignature(m_rootSignature.Get());
 	// Set viewport and scissor.
-	command->RSSetViewports(1, &m_viewport);
-	command->RSSetScissorRects(1, &m_scissorRect);
+	m_stateCommandList.RSSetViewports(1, &m_viewport);
+	m_stateCommandList.RSSetScissorRects(1, &m_scissorRect);
 
 	// Set the Primitive, Vertex, Index buffers.
-	command->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	command->IASetVertexBuffers(0, 1, &m_vertexBufferView);
-	command->IASetIndexBuffer(&m_indexBufferView);
+	m_stateCommandList.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	m_stateCommandList.IASetVertexBuffers(0, 1, &m_vertexBufferView);
+	m_stateCommandList.IASetIndexBuffer(&m_indexBufferView);
 
 	// Render order.
-	command->DrawIndexedInstanced(m_indexCount, 1, 0, 0, 0);
-}
-
-TriangleApp::ComPtr<ID3D12Resource1> TriangleApp::CreateBuffer(UINT bufferSize, const void* initialData)
-{
-	HRESULT hr;
-	ComPtr<ID3D12Resource1> buffer;
-	hr = m_device->CreateCommittedResource(
-		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
-		D3D12_HEAP_FLAG_NONE,
-		&CD3DX12_RESOURCE_DESC::Buffer(bufferSize),
-		D3D12_RESOURCE_STATE_GENERIC_READ,
-		nullptr,
-		IID_PPV_ARGS(&buffer)
-	);
-
-	// Copy when there is assignment of initial data.
-	if(SUCCEEDED(hr) && initialData != nullptr)
-	{
-		void* mapped;
-		CD3DX12_RANGE range(0, 0);
-		hr = buffer->Map(0, &range, &mapped);
-		if(SUCCEEDED(hr))
-		{
-			memcpy(mapped, initialData, bufferSize);
-			buffer->Unmap(0, nullptr);
-		}
-	}
-
-	return buffer;
+	m_stateCommandList.DrawIndexedInstanced(m_indexCount, 1, 0, 0, 0);
 }
\ No newline at end of file
@@ -2,7 +2,6 @@
 
 #include "../util/D3D12AppBase.h"
 #include "../util/mathutil.h"
-#include "../dfGraphics/dfShader.h"
 
 class TriangleApp : public D3D12AppBase {
 public:
@@ -12,22 +11,24 @@ public:
 	virtual void Cleanup() override;
 	virtual void MakeCommand(ComPtr<ID3D12GraphicsCommandList>& command) override;
 
+	// Shaders loaded in Setup(), and packed into the archive by "--pack-shaders".
+	static const std::vector<ShaderCompileJob>& GetShaderJobs();
+
 	struct Vertex {
 		Vector3 Pos;
 		Vector4 Color;
 	};
 
 private:
-	ComPtr<ID3D12Resource1> CreateBuffer(UINT bufferSize, const void* initialData);
-
 	ComPtr<ID3D12Resource1> m_vertexBuffer;
 	ComPtr<ID3D12Resource1> m_indexBuffer;
+	HeapAllocation m_vertexBufferAllocation;
+	HeapAllocation m_indexBufferAllocation;
 	D3D12_VERTEX_BUFFER_VIEW m_vertexBufferView;
 	D3D12_INDEX_BUFFER_VIEW m_indexBufferView;
 	UINT m_indexCount;
 
-	dfShader m_shader;
-	//ComPtr<ID3DBlob> m_vs, m_ps;
+	ComPtr<ID3DBlob> m_vs, m_ps;
 	ComPtr<ID3D12RootSignature> m_rootSignature;
 	ComPtr<ID3D12PipelineState> m_pipeline;
 
@@ -1,6 +1,7 @@
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
 #include <stdexcept>
+#include <cstring>
 #include "TriangleApp.h"
 
 const int WINDOW_WIDTH = 1280;
@@ -26,10 +27,25 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wp, LPARAM lp)
 	return DefWindowProc(hWnd, msg, wp, lp);
 }
 
-int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int nCmdShow)
+int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR lpCmdLine, int nCmdShow)
 {
 	TriangleApp theApp{};
 
+	// Packing step, e.g. a post-build event: Triangle.exe --pack-shaders
+	if (strstr(lpCmdLine, "--pack-shaders"))
+	{
+		try
+		{
+			return theApp.PackShaders(TriangleApp::GetShaderJobs()) ? 0 : 1;
+		}
+		catch (const std::exception& e)
+		{
+			OutputDebugStringA(e.what());
+			OutputDebugStringA("\n");
+			return 1;
+		}
+	}
+
 	// Reistration of window class and Determining the window size.
 	// ex) RegisterClassEx and CreateWindow
 	WNDCLASSEX wc{};
@@ -1,10 +1,6 @@
 #include "dfShader.h"
 #include "../util/util.h"
 
-// For DirectX Shader Compiler.
-#include <dxcapi.h>
-#pragma comment(lib, "dxcompiler.lib")
-
 // ============================================================================
 dfShader::dfShader() {
     vs = nullptr;
@@ -31,53 +27,6 @@ HRESULT dfShader::CompileShaderFromFile(
     const std::wstring& filename, const std::wstring& profile, ComPtr<ID3DBlob>& shaderBlob, ComPtr<ID3DBlob>& errorBlob
 )
 {
-    using namespace std::experimental::filesystem;
-
-    path filePath(filename);
-    std::ifstream infile(filePath);
-    std::vector<char> srcData;
-    if(!infile)
-        throw std::runtime_error("shader not found.");
-    srcData.resize(uint32_t(infile.seekg(0, infile.end).tellg()));
-    infile.seekg(0, infile.beg).read(srcData.data(), srcData.size());
-
-    // Compiling process by DXC (DirectX Shader Compiler.)
-    ComPtr<IDxcLibrary> library;
-    ComPtr<IDxcCompiler> compiler;
-    ComPtr<IDxcBlobEncoding> source;
-    ComPtr<IDxcOperationResult> dxcResult;
-
-    DxcCreateInstance(CLSID_DxcLibrary, IID_PPV_ARGS(&library));
-    library->CreateBlobWithEncodingFromPinned(srcData.data(), UINT(srcData.size()), CP_ACP, &source);
-    DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&compiler));
-
-    LPCWSTR compilerFlags[] = {
-#if _DEBUG
-        L"/Zi", L"/O0",
-#else
-        L"/O2" // Optimizing in Release build.
-#endif
-    };
-    compiler->Compile(source.Get(), filePath.wstring().c_str(),
-        L"main", profile.c_str(),
-        compilerFlags, _countof(compilerFlags),
-        nullptr, 0,
-        nullptr,
-        &dxcResult);
-
-    HRESULT hr;
-    dxcResult->GetStatus(&hr);
-    if (SUCCEEDED(hr))
-    {
-        dxcResult->GetResult(
-            reinterpret_cast<IDxcBlob**>(shaderBlob.GetAddressOf())
-        );
-    }
-    else
-    {
-        dxcResult->GetErrorBuffer(
-            reinterpret_cast<IDxcBlobEncoding**>(errorBlob.GetAddressOf())
-        );
-    }
-    return hr;
+    // DXC runs only when the shader cache doesn't have the output of this source.
+    return _compiler.CompileFromFile(filename, L"main", profile, {}, shaderBlob, errorBlob);
 }
\ No newline at end of file
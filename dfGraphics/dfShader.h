@@ -3,6 +3,7 @@
 #include <d3d12.h>
 #include <dxgi1_6.h>
 #include "../util/util.h"
+#include "../util/ShaderCompiler.h"
 
 // #include "../util/d3dx12.h"
 
@@ -31,5 +32,6 @@ public:
 
 private:
 	D3D12_BLEND_DESC _blendState;
+	ShaderCompiler _compiler;
 
 };
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "BuddyAllocator.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Compares placing resources in 64MB heaps with the buddy allocator against one committed
+// resource each, whose implicit heap is rounded up to 64KB.
+// Only the CPU side is measured here; ResourceHeapBenchmark measures the driver calls on Windows.
+namespace {
+	const uint64_t PlacementAlignment = 64 * 1024;
+	const uint64_t HeapSize = 64 * 1024 * 1024;
+
+	uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	// Sizes between 256B and 4MB, uniform in log scale like a mix of constant buffers, meshes and textures.
+	std::vector<uint64_t> MakeSizes(size_t count, unsigned seed)
+	{
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<double> logSize(std::log(256.0), std::log(4.0 * 1024 * 1024));
+		std::vector<uint64_t> sizes(count);
+		for (auto& size : sizes)
+			size = uint64_t(std::exp(logSize(random)));
+		return sizes;
+	}
+}
+
+int main()
+{
+	std::printf("%10s %12s %12s %14s %14s %10s\n", "resources", "alloc(ns)", "free(ns)", "buddy waste", "commit waste", "heaps");
+
+	for (size_t count : { 1000, 10000, 100000 })
+	{
+		const auto sizes = MakeSizes(count, 42);
+
+		std::vector<BuddyAllocator> heaps;
+		std::vector<std::pair<size_t, uint64_t>> allocations(count);
+
+		const auto allocStart = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < count; i++)
+		{
+			uint64_t offset = BuddyAllocator::InvalidOffset;
+			size_t heap = 0;
+			for (; heap < heaps.size(); heap++)
+			{
+				offset = heaps[heap].Allocate(sizes[i], PlacementAlignment);
+				if (offset != BuddyAllocator::InvalidOffset)
+					break;
+			}
+			if (offset == BuddyAllocator::InvalidOffset)
+			{
+				heaps.emplace_back(HeapSize, PlacementAlignment);
+				offset = heaps.back().Allocate(sizes[i], PlacementAlignment);
+			}
+			allocations[i] = { heap, offset };
+		}
+		const auto allocEnd = std::chrono::steady_clock::now();
+
+		uint64_t requested = 0;
+		uint64_t committed = 0;
+		for (auto size : sizes)
+		{
+			requested += size;
+			committed += AlignUp(size, PlacementAlignment);
+		}
+		// Whole heaps count as used memory for the buddy allocator, free space included.
+		const uint64_t heapBytes = uint64_t(heaps.size()) * HeapSize;
+
+		const auto freeStart = std::chrono::steady_clock::now();
+		for (const auto& allocation : allocations)
+			heaps[allocation.first].Free(allocation.second);
+		const auto freeEnd = std::chrono::steady_clock::now();
+
+		const double allocNs = std::chrono::duration<double, std::nano>(allocEnd - allocStart).count() / count;
+		const double freeNs = std::chrono::duration<double, std::nano>(freeEnd - freeStart).count() / count;
+		std::printf("%10zu %12.1f %12.1f %13.1f%% %13.1f%% %10zu\n", count, allocNs, freeNs,
+			100.0 * double(heapBytes - requested) / double(heapBytes),
+			100.0 * double(committed - requested) / double(committed),
+			heaps.size());
+	}
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "Test.h"
+#include "BuddyAllocator.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+	const uint64_t MinBlock = 64 * 1024;
+	const uint64_t HeapSize = 16 * MinBlock;
+}
+
+TEST_CASE(BuddyAllocator_SplitsDownToRequestedOrder)
+{
+	BuddyAllocator allocator(HeapSize, MinBlock);
+
+	CHECK(allocator.Allocate(1000) == 0);
+	// 16 blocks split into 8 + 4 + 2 + 1 free blocks next to the allocated one.
+	auto stats = allocator.GetStats();
+	CHECK(stats.freeBlockCount == 4);
+	CHECK(stats.largestFreeBlock == 8 * MinBlock);
+	CHECK(stats.freeBytes == HeapSize - MinBlock);
+
+	// The next small allocations use the split halves before splitting larger blocks.
+	CHECK(allocator.Allocate(MinBlock) == MinBlock);
+	CHECK(allocator.GetStats().freeBlockCount == 3);
+}
+
+TEST_CASE(BuddyAllocator_MergesBuddiesOnFree)
+{
+	BuddyAllocator allocator(HeapSize, MinBlock);
+	std::vector<uint64_t> offsets;
+	for (int i = 0; i < 16; i++)
+		offsets.push_back(allocator.Allocate(MinBlock));
+	CHECK(allocator.GetStats().freeBytes == 0);
+	CHECK(allocator.Allocate(1) == BuddyAllocator::InvalidOffset);
+
+	// Freeing every other block leaves no buddy pair to merge.
+	for (size_t i = 0; i < offsets.size(); i += 2)
+		allocator.Free(offsets[i]);
+	auto stats = allocator.GetStats();
+	CHECK(stats.freeBlockCount == 8);
+	CHECK(stats.largestFreeBlock == MinBlock);
+	CHECK(stats.Fragmentation() > 0.8);
+	CHECK(allocator.Allocate(2 * MinBlock) == BuddyAllocator::InvalidOffset);
+
+	// The rest merges back into the whole heap.
+	for (size_t i = 1; i < offsets.size(); i += 2)
+		allocator.Free(offsets[i]);
+	stats = allocator.GetStats();
+	CHECK(allocator.IsEmpty());
+	CHECK(stats.freeBlockCount == 1);
+	CHECK(stats.largestFreeBlock == HeapSize);
+	CHECK(stats.Fragmentation() == 0.0);
+	CHECK(allocator.Allocate(HeapSize) == 0);
+}
+
+TEST_CASE(BuddyAllocator_HonorsAlignment)
+{
+	BuddyAllocator allocator(HeapSize, MinBlock);
+	CHECK(allocator.Allocate(MinBlock) == 0);
+
+	// A small resource with 4MB alignment, like an MSAA texture, takes a 4MB aligned block.
+	const uint64_t alignment = 4 * MinBlock;
+	const uint64_t offset = allocator.Allocate(MinBlock, alignment);
+	CHECK(offset != BuddyAllocator::InvalidOffset);
+	CHECK(offset % alignment == 0);
+	CHECK(allocator.GetStats().allocatedBytes == MinBlock + alignment);
+
+	// Alignment larger than the heap can't be satisfied.
+	CHECK(allocator.Allocate(MinBlock, 2 * HeapSize) == BuddyAllocator::InvalidOffset);
+}
+
+TEST_CASE(BuddyAllocator_FailsWhenOutOfMemory)
+{
+	BuddyAllocator allocator(HeapSize, MinBlock);
+	CHECK(allocator.Allocate(0) == BuddyAllocator::InvalidOffset);
+	CHECK(allocator.Allocate(HeapSize + 1) == BuddyAllocator::InvalidOffset);
+
+	const uint64_t half = allocator.Allocate(HeapSize / 2 + 1);
+	CHECK(half == 0);
+	// The request was rounded up to the whole heap.
+	CHECK(allocator.Allocate(1) == BuddyAllocator::InvalidOffset);
+
+	// Freeing an unknown offset is ignored.
+	allocator.Free(12345);
+	CHECK(!allocator.IsEmpty());
+	allocator.Free(half);
+	CHECK(allocator.Allocate(HeapSize / 2) == 0);
+	CHECK(allocator.Allocate(HeapSize / 2) == HeapSize / 2);
+	CHECK(allocator.Allocate(MinBlock) == BuddyAllocator::InvalidOffset);
+}
+
+TEST_CASE(BuddyAllocator_TracksRequestedAndAllocatedBytes)
+{
+	BuddyAllocator allocator(HeapSize, MinBlock);
+	const uint64_t a = allocator.Allocate(MinBlock + 1);
+	const uint64_t b = allocator.Allocate(100);
+	auto stats = allocator.GetStats();
+	CHECK(stats.allocationCount == 2);
+	CHECK(stats.requestedBytes == MinBlock + 1 + 100);
+	CHECK(stats.allocatedBytes == 3 * MinBlock);
+	CHECK(stats.InternalWaste() == 3 * MinBlock - (MinBlock + 101));
+	CHECK(stats.freeBytes == HeapSize - 3 * MinBlock);
+
+	allocator.Free(a);
+	allocator.Free(b);
+	stats = allocator.GetStats();
+	CHECK(stats.allocationCount == 0);
+	CHECK(stats.requestedBytes == 0);
+	CHECK(stats.allocatedBytes == 0);
+	CHECK(stats.freeBytes == HeapSize);
+}
+
+TEST_CASE(BuddyAllocator_RandomAllocationsNeverOverlap)
+{
+	const uint64_t size = 1024 * MinBlock;
+	BuddyAllocator allocator(size, MinBlock);
+	std::mt19937 random(7);
+	std::vector<std::pair<uint64_t, uint64_t>> live; // offset, size
+
+	for (int i = 0; i < 5000; i++)
+	{
+		if (!live.empty() && random() % 3 == 0)
+		{
+			const size_t index = random() % live.size();
+			allocator.Free(live[index].first);
+			live[index] = live.back();
+			live.pop_back();
+			continue;
+		}
+		const uint64_t request = 1 + random() % (32 * MinBlock);
+		const uint64_t offset = allocator.Allocate(request);
+		if (offset == BuddyAllocator::InvalidOffset)
+			continue;
+		CHECK(offset + request <= size);
+		for (const auto& other : live)
+			CHECK(offset + request <= other.first || other.first + other.second <= offset);
+		live.push_back({ offset, request });
+	}
+
+	for (const auto& allocation : live)
+		allocator.Free(allocation.first);
+	CHECK(allocator.IsEmpty());
+	CHECK(allocator.GetStats().largestFreeBlock == size);
+}
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "Test.h"
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <random>
+
+namespace {
+
+// Queue fence on a simulated GPU in virtual time. Every signalled value completes when the GPU has
+// executed the frame submitted before it; frames execute in submission order.
+class SimulatedFence : public FrameFence {
+public:
+	double now = 0.0;			// CPU time.
+	double waitTime = 0.0;		// CPU time spent blocked in Wait().
+	double gpuFreeTime = 0.0;	// Time the GPU finishes the last submitted frame.
+	double nextGpuCost = 0.0;	// GPU cost of the frame signalled next.
+	std::vector<double> completionTimes{ 0.0 }; // Indexed by fence value, value 0 is complete from the start.
+
+	uint64_t Signal() override
+	{
+		const double start = std::max(now, gpuFreeTime);
+		gpuFreeTime = start + nextGpuCost;
+		completionTimes.push_back(gpuFreeTime);
+		return completionTimes.size() - 1;
+	}
+
+	uint64_t GetCompletedValue() const override
+	{
+		uint64_t value = 0;
+		while (value + 1 < completionTimes.size() && completionTimes[value + 1] <= now) {
+			++value;
+		}
+		return value;
+	}
+
+	void Wait(uint64_t value) override
+	{
+		if (completionTimes[value] > now) {
+			waitTime += completionTimes[value] - now;
+			now = completionTimes[value];
+		}
+	}
+
+	uint64_t GetLastValue() const { return completionTimes.size() - 1; }
+};
+
+struct PacingResult {
+	double overlap;			// Fraction of the run where CPU and GPU were both busy.
+	uint32_t maxInFlight;	// Most frames submitted but not completed while recording a frame.
+};
+
+PacingResult RunFrames(uint32_t framesInFlight, uint32_t frameCount)
+{
+	SimulatedFence fence;
+	FramePacer pacer;
+	pacer.Initialize(&fence, framesInFlight);
+
+	// Same CPU and mean GPU cost, GPU cost jitters from frame to frame.
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<double> jitter(0.2, 1.8);
+	const double cpuCost = 1.0;
+
+	double cpuBusy = 0.0;
+	double gpuBusy = 0.0;
+	PacingResult result = {};
+	for (uint32_t frame = 0; frame < frameCount; ++frame) {
+		// Frames still on the GPU, counting the one being recorded.
+		const uint32_t inFlight = uint32_t(fence.GetLastValue() - fence.GetCompletedValue()) + 1;
+		result.maxInFlight = std::max(result.maxInFlight, inFlight);
+
+		fence.now += cpuCost;
+		cpuBusy += cpuCost;
+		fence.nextGpuCost = cpuCost * jitter(random);
+		gpuBusy += fence.nextGpuCost;
+
+		pacer.EndFrame();
+		pacer.AdvanceFrame();
+	}
+
+	const double total = std::max(fence.now, fence.gpuFreeTime);
+	result.overlap = (cpuBusy + gpuBusy - total) / total;
+	return result;
+}
+
+} // namespace
+
+TEST_CASE(FramePacer_CyclesSlotsAndWaitsOnOldestFrame)
+{
+	SimulatedFence fence;
+	fence.nextGpuCost = 10.0;
+	FramePacer pacer;
+	pacer.Initialize(&fence, 3);
+
+	// The first frames fill the slots without waiting.
+	for (uint32_t frame = 0; frame < 3; ++frame) {
+		CHECK(pacer.GetFrameIndex() == frame);
+		CHECK(pacer.EndFrame() == frame + 1);
+		if (frame < 2) {
+			pacer.AdvanceFrame();
+			CHECK(fence.waitTime == 0.0);
+		}
+	}
+
+	// Reusing slot 0 waits for the first frame only.
+	pacer.AdvanceFrame();
+	CHECK(pacer.GetFrameIndex() == 0);
+	CHECK(fence.now == fence.completionTimes[1]);
+	CHECK(fence.GetCompletedValue() == 1);
+	CHECK(pacer.GetFrameFenceValue(1) == 2);
+	CHECK(pacer.GetFrameFenceValue(2) == 3);
+}
+
+TEST_CASE(FramePacer_BoundsFramesInFlight)
+{
+	for (uint32_t framesInFlight = 1; framesInFlight <= 4; ++framesInFlight) {
+		const auto result = RunFrames(framesInFlight, 500);
+		CHECK(result.maxInFlight <= framesInFlight);
+	}
+}
+
+TEST_CASE(FramePacer_MoreFramesInFlightOverlapCpuAndGpu)
+{
+	const auto one = RunFrames(1, 500);
+	const auto two = RunFrames(2, 500);
+	const auto four = RunFrames(4, 500);
+	std::printf("  overlap: 1 frame %.3f, 2 frames %.3f, 4 frames %.3f\n", one.overlap, two.overlap, four.overlap);
+
+	// A single frame in flight serializes CPU and GPU.
+	CHECK(one.overlap < 0.01);
+	CHECK(two.overlap > one.overlap);
+	// Deeper queue absorbs the GPU cost jitter.
+	CHECK(four.overlap > two.overlap);
+}
\ No newline at end of file
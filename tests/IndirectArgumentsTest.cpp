@@ -0,0 +1,135 @@
+#include "Test.h"
+#include "IndirectArguments.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// Layout of InstanceBatcher's commands: the mesh buffers and the instanced draw.
+IndirectCommandLayout MakeMeshLayout()
+{
+	IndirectCommandLayout layout;
+	layout.AddVertexBufferView(0).AddIndexBufferView().AddDrawIndexed();
+	return layout;
+}
+
+template<class T>
+T Read(const UINT8* data, UINT offset)
+{
+	T value;
+	memcpy(&value, data + offset, sizeof(T));
+	return value;
+}
+
+} // namespace
+
+TEST_CASE(IndirectCommandLayout_PacksArgumentsInOrder)
+{
+	const auto layout = MakeMeshLayout();
+	CHECK(layout.GetArgumentCount() == 3);
+	CHECK(layout.GetOffset(0) == 0);
+	CHECK(layout.GetOffset(1) == sizeof(D3D12_VERTEX_BUFFER_VIEW));
+	CHECK(layout.GetOffset(2) == sizeof(D3D12_VERTEX_BUFFER_VIEW) + sizeof(D3D12_INDEX_BUFFER_VIEW));
+	CHECK(layout.GetStride() == sizeof(D3D12_VERTEX_BUFFER_VIEW) + sizeof(D3D12_INDEX_BUFFER_VIEW) + sizeof(D3D12_DRAW_INDEXED_ARGUMENTS));
+	CHECK(layout.IsComplete());
+	CHECK(!layout.HasRootArguments());
+
+	const auto desc = layout.GetDesc();
+	CHECK(desc.ByteStride == layout.GetStride());
+	CHECK(desc.NumArgumentDescs == 3);
+	CHECK(desc.pArgumentDescs[2].Type == D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED);
+
+	IndirectCommandLayout constants;
+	constants.AddConstants(1, 4).AddDispatch();
+	CHECK(constants.HasRootArguments());
+	CHECK(constants.GetStride() == 4 * sizeof(UINT) + sizeof(D3D12_DISPATCH_ARGUMENTS));
+}
+
+TEST_CASE(IndirectCommandLayout_RejectsIncompleteLayouts)
+{
+	IndirectCommandLayout layout;
+	layout.AddDraw();
+	bool threw = false;
+	try { layout.AddIndexBufferView(); } catch (const std::runtime_error&) { threw = true; }
+	CHECK(threw);
+
+	// The device isn't touched when the layout has no draw or dispatch.
+	IndirectCommandLayout incomplete;
+	incomplete.AddVertexBufferView(0);
+	IndirectCommandLayout::ComPtr<ID3D12CommandSignature> signature;
+	CHECK(incomplete.CreateCommandSignature(nullptr, nullptr, signature) == E_INVALIDARG);
+}
+
+TEST_CASE(IndirectArgumentBuffer_WritesArgumentsAtTheirOffsets)
+{
+	const auto layout = MakeMeshLayout();
+	IndirectArgumentBuffer buffer;
+	buffer.Reset(layout);
+	CHECK(buffer.GetCount() == 0);
+	CHECK(buffer.GetSize() == 0);
+
+	const UINT first = buffer.Append();
+	const UINT second = buffer.Append();
+	CHECK(first == 0 && second == 1);
+	CHECK(buffer.GetSize() == 2 * layout.GetStride());
+
+	D3D12_VERTEX_BUFFER_VIEW vertexBuffer{ 0x1000, 256, 32 };
+	D3D12_DRAW_INDEXED_ARGUMENTS draw{ 36, 10, 0, 0, 5 };
+	buffer.Write(second, 0, vertexBuffer);
+	buffer.Write(second, 2, draw);
+
+	const UINT8* command = buffer.GetData() + layout.GetStride();
+	CHECK(Read<D3D12_VERTEX_BUFFER_VIEW>(command, layout.GetOffset(0)).BufferLocation == 0x1000);
+	CHECK(Read<D3D12_DRAW_INDEXED_ARGUMENTS>(command, layout.GetOffset(2)).InstanceCount == 10);
+	CHECK(Read<D3D12_DRAW_INDEXED_ARGUMENTS>(command, layout.GetOffset(2)).StartInstanceLocation == 5);
+	// Appended commands are zero filled.
+	CHECK(Read<D3D12_DRAW_INDEXED_ARGUMENTS>(buffer.GetData(), layout.GetOffset(2)).InstanceCount == 0);
+
+	bool threw = false;
+	try { buffer.Write(first, 1, draw); } catch (const std::runtime_error&) { threw = true; }
+	CHECK(threw);
+}
+
+TEST_CASE(IndirectArgumentBuffer_CompactKeepsVisibleCommandsInOrder)
+{
+	IndirectCommandLayout layout;
+	layout.AddDraw();
+	IndirectArgumentBuffer buffer;
+	buffer.Reset(layout);
+	for (UINT i = 0; i < 5; i++)
+		buffer.Write(buffer.Append(), 0, D3D12_DRAW_ARGUMENTS{ 3, i, 0, 0 });
+
+	const uint8_t visible[] = { 0, 1, 0, 1, 1 };
+	CHECK(buffer.Compact(visible) == 3);
+	CHECK(buffer.GetCount() == 3);
+	CHECK(buffer.GetSize() == 3 * sizeof(D3D12_DRAW_ARGUMENTS));
+	const UINT expected[] = { 1, 3, 4 };
+	for (UINT i = 0; i < 3; i++)
+		CHECK(Read<D3D12_DRAW_ARGUMENTS>(buffer.GetData(), i * layout.GetStride()).InstanceCount == expected[i]);
+
+	const uint8_t none[] = { 0, 0, 0 };
+	CHECK(buffer.Compact(none) == 0);
+	CHECK(buffer.GetSize() == 0);
+}
+
+TEST_CASE(IndirectArgumentBuffer_KeepsItsLayoutWhenCopied)
+{
+	IndirectArgumentBuffer copy;
+	{
+		// Per-draw root constant before the draw, as InstanceBatcher packs the material.
+		IndirectCommandLayout layout;
+		layout.AddConstants(2, 1).AddDrawIndexed();
+		IndirectArgumentBuffer buffer;
+		buffer.Reset(layout);
+		buffer.Write(buffer.Append(), 0, UINT(7));
+		copy = buffer;
+	}
+
+	// The layout and the original buffer are gone, the copy still writes at the right offsets.
+	D3D12_DRAW_INDEXED_ARGUMENTS draw{ 36, 4, 0, 0, 0 };
+	copy.Write(0, 1, draw);
+	CHECK(copy.GetStride() == sizeof(UINT) + sizeof(D3D12_DRAW_INDEXED_ARGUMENTS));
+	CHECK(Read<UINT>(copy.GetData(), 0) == 7);
+	CHECK(Read<D3D12_DRAW_INDEXED_ARGUMENTS>(copy.GetData(), sizeof(UINT)).InstanceCount == 4);
+}
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "Test.h"
+#include "ParallelJobRunner.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// Stands in for a command list: recording a draw costs a little CPU and writes into the list's own memory.
+struct FakeCommandList {
+	std::vector<uint32_t> commands;
+	uint64_t checksum = 0;
+
+	void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance)
+	{
+		commands.push_back(indexCount);
+		uint64_t h = checksum ^ (uint64_t(indexCount) << 32 | instanceCount);
+		for (int i = 0; i < 64; i++)
+			h = h * 6364136223846793005ull + 1442695040888963407ull + startIndex + uint32_t(baseVertex) + startInstance;
+		checksum = h;
+	}
+};
+
+// Record jobCount lists of drawsPerJob draws like ParallelCommandRecorder does, and return the milliseconds.
+double RecordFrame(ParallelJobRunner& runner, std::vector<FakeCommandList>& lists, uint32_t drawsPerJob)
+{
+	for (auto& list : lists)
+		list = FakeCommandList();
+	const auto start = std::chrono::steady_clock::now();
+	runner.Run(uint32_t(lists.size()), [&lists, drawsPerJob](uint32_t job) {
+		auto& list = lists[job];
+		for (uint32_t draw = 0; draw < drawsPerJob; draw++)
+			list.DrawIndexedInstanced(36, 1, 0, 0, job * drawsPerJob + draw);
+	});
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+TEST_CASE(ParallelJobRunner_RunsEveryJobOnce)
+{
+	ParallelJobRunner runner(3);
+	for (uint32_t jobCount : { 0u, 1u, 2u, 7u, 100u })
+	{
+		std::vector<std::atomic<uint32_t>> runs(jobCount);
+		runner.Run(jobCount, [&runs](uint32_t job) { runs[job]++; });
+		bool once = true;
+		for (auto& count : runs)
+			once &= count == 1;
+		CHECK(once);
+	}
+}
+
+TEST_CASE(ParallelJobRunner_RethrowsFirstJobException)
+{
+	ParallelJobRunner runner(2);
+	std::atomic<uint32_t> finished{ 0 };
+	bool thrown = false;
+	try
+	{
+		runner.Run(16, [&finished](uint32_t job) {
+			if (job == 5)
+				throw std::runtime_error("job failed");
+			finished++;
+		});
+	}
+	catch (const std::runtime_error&)
+	{
+		thrown = true;
+	}
+	CHECK(thrown);
+	// The other jobs still ran, and the runner is usable afterwards.
+	CHECK(finished == 15);
+	finished = 0;
+	runner.Run(4, [&finished](uint32_t) { finished++; });
+	CHECK(finished == 4);
+}
+
+TEST_CASE(ParallelJobRunner_RecordsFakeListsLikeSerialRecording)
+{
+	const uint32_t jobCount = 16;
+	const uint32_t drawsPerJob = 500;
+	ParallelJobRunner serial(1);
+	ParallelJobRunner parallel(4);
+	std::vector<FakeCommandList> expected(jobCount), lists(jobCount);
+
+	// One job at a time on the calling thread gives the reference lists.
+	for (uint32_t job = 0; job < jobCount; job++)
+	{
+		serial.Run(1, [&expected, job, drawsPerJob](uint32_t) {
+			for (uint32_t draw = 0; draw < drawsPerJob; draw++)
+				expected[job].DrawIndexedInstanced(36, 1, 0, 0, job * drawsPerJob + draw);
+		});
+	}
+	RecordFrame(parallel, lists, drawsPerJob);
+	for (uint32_t job = 0; job < jobCount; job++)
+	{
+		CHECK(lists[job].commands.size() == drawsPerJob);
+		CHECK(lists[job].checksum == expected[job].checksum);
+	}
+}
+
+TEST_CASE(ParallelJobRunner_RecordingScaling)
+{
+	// Frame split into 32 lists of 2000 draws. Prints the time per frame for each worker count;
+	// the speedup is bounded by the cores of the machine, so it is reported rather than checked.
+	const uint32_t jobCount = 32;
+	const uint32_t drawsPerJob = 2000;
+	const int frames = 5;
+	std::vector<FakeCommandList> lists(jobCount);
+
+	std::printf("  hardware threads: %u\n", std::thread::hardware_concurrency());
+	double serialMs = 0.0;
+	for (uint32_t workers : { 1u, 2u, 4u, 8u })
+	{
+		ParallelJobRunner runner(workers);
+		RecordFrame(runner, lists, drawsPerJob); // Starts the workers.
+		double total = 0.0;
+		for (int frame = 0; frame < frames; frame++)
+			total += RecordFrame(runner, lists, drawsPerJob);
+		const double ms = total / frames;
+		if (workers == 1)
+			serialMs = ms;
+		std::printf("  %u worker(s) + caller: %.3f ms/frame, speedup %.2fx\n", workers, ms, serialMs / ms);
+
+		uint64_t draws = 0;
+		for (const auto& list : lists)
+			draws += list.commands.size();
+		CHECK(draws == uint64_t(jobCount) * drawsPerJob);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,233 @@
+#include "Test.h"
+#include "PipelineStateCache.h"
+
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <string>
+
+namespace {
+
+const uint8_t VertexShader[] = { 0x44, 0x58, 0x42, 0x43, 1, 2, 3, 4 };
+const uint8_t PixelShader[] = { 0x44, 0x58, 0x42, 0x43, 5, 6, 7, 8 };
+const uint64_t RootSignatureHash = 0x1234;
+
+// Desc of a textured mesh. Every field is assigned after the whole struct is filled with fill,
+// so only the padding differs between fills.
+struct TestDesc {
+	std::string position = "POSITION";
+	std::string texcoord = "TEXCOORD";
+	D3D12_INPUT_ELEMENT_DESC elements[2];
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC desc;
+
+	// The desc points into this object.
+	TestDesc(const TestDesc&) = delete;
+	TestDesc& operator=(const TestDesc&) = delete;
+
+	explicit TestDesc(uint8_t fill = 0)
+	{
+		memset(elements, fill, sizeof(elements));
+		for (auto& element : elements)
+		{
+			element.SemanticIndex = 0;
+			element.InputSlot = 0;
+			element.InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA;
+			element.InstanceDataStepRate = 0;
+		}
+		elements[0].SemanticName = position.c_str();
+		elements[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+		elements[0].AlignedByteOffset = 0;
+		elements[1].SemanticName = texcoord.c_str();
+		elements[1].Format = DXGI_FORMAT_R32G32_FLOAT;
+		elements[1].AlignedByteOffset = 12;
+
+		memset(&desc, fill, sizeof(desc));
+		desc.pRootSignature = nullptr;
+		desc.VS = { VertexShader, sizeof(VertexShader) };
+		desc.PS = { PixelShader, sizeof(PixelShader) };
+		desc.DS = {};
+		desc.HS = {};
+		desc.GS = {};
+		desc.StreamOutput = {};
+
+		desc.BlendState.AlphaToCoverageEnable = FALSE;
+		desc.BlendState.IndependentBlendEnable = FALSE;
+		for (auto& rt : desc.BlendState.RenderTarget)
+		{
+			rt.BlendEnable = FALSE;
+			rt.LogicOpEnable = FALSE;
+			rt.SrcBlend = D3D12_BLEND_ONE;
+			rt.DestBlend = D3D12_BLEND_ZERO;
+			rt.BlendOp = D3D12_BLEND_OP_ADD;
+			rt.SrcBlendAlpha = D3D12_BLEND_ONE;
+			rt.DestBlendAlpha = D3D12_BLEND_ZERO;
+			rt.BlendOpAlpha = D3D12_BLEND_OP_ADD;
+			rt.LogicOp = D3D12_LOGIC_OP_NOOP;
+			rt.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
+		}
+		desc.SampleMask = UINT_MAX;
+
+		auto& raster = desc.RasterizerState;
+		raster.FillMode = D3D12_FILL_MODE_SOLID;
+		raster.CullMode = D3D12_CULL_MODE_BACK;
+		raster.FrontCounterClockwise = FALSE;
+		raster.DepthBias = 0;
+		raster.DepthBiasClamp = 0.0f;
+		raster.SlopeScaledDepthBias = 0.0f;
+		raster.DepthClipEnable = TRUE;
+		raster.MultisampleEnable = FALSE;
+		raster.AntialiasedLineEnable = FALSE;
+		raster.ForcedSampleCount = 0;
+		raster.ConservativeRaster = D3D12_CONSERVATIVE_RASTERIZATION_MODE_OFF;
+
+		auto& depth = desc.DepthStencilState;
+		depth.DepthEnable = TRUE;
+		depth.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ALL;
+		depth.DepthFunc = D3D12_COMPARISON_FUNC_LESS;
+		depth.StencilEnable = FALSE;
+		depth.StencilReadMask = 0xFF;
+		depth.StencilWriteMask = 0xFF;
+		depth.FrontFace = { D3D12_STENCIL_OP_KEEP, D3D12_STENCIL_OP_KEEP, D3D12_STENCIL_OP_KEEP, D3D12_COMPARISON_FUNC_ALWAYS };
+		depth.BackFace = depth.FrontFace;
+
+		desc.InputLayout = { elements, 2 };
+		desc.IBStripCutValue = D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_DISABLED;
+		desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+		desc.NumRenderTargets = 1;
+		for (auto& format : desc.RTVFormats)
+			format = DXGI_FORMAT_UNKNOWN;
+		desc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
+		desc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
+		desc.SampleDesc = { 1, 0 };
+		desc.NodeMask = 0;
+		desc.CachedPSO = {};
+		desc.Flags = D3D12_PIPELINE_STATE_FLAG_NONE;
+	}
+
+	uint64_t Key(uint64_t rootSignatureHash = RootSignatureHash) const { return PipelineStateKey::Hash(desc, rootSignatureHash); }
+};
+
+// Pipeline state which only counts its references, returned by the create functions of the tests.
+class FakePipelineState : public ID3D12PipelineState {
+public:
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID, void** object) override { *object = nullptr; return E_NOINTERFACE; }
+	ULONG STDMETHODCALLTYPE AddRef() override { return ++m_refCount; }
+	ULONG STDMETHODCALLTYPE Release() override
+	{
+		const ULONG count = --m_refCount;
+		if (count == 0)
+			delete this;
+		return count;
+	}
+	HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID, UINT*, void*) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID, UINT, const void*) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID, const IUnknown*) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE SetName(LPCWSTR) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE GetDevice(REFIID, void** device) override { *device = nullptr; return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE GetCachedBlob(ID3DBlob** blob) override { *blob = nullptr; return E_NOTIMPL; }
+
+private:
+	std::atomic<ULONG> m_refCount{ 1 };
+};
+
+} // namespace
+
+TEST_CASE(PipelineStateKey_EqualDescsGiveEqualKeys)
+{
+	// The semantic names are separate strings with the same contents.
+	TestDesc a, b;
+	CHECK(a.elements[0].SemanticName != b.elements[0].SemanticName);
+	CHECK(a.Key() == b.Key());
+
+	// The shader is hashed by its bytes, not by its address.
+	uint8_t copy[sizeof(VertexShader)];
+	memcpy(copy, VertexShader, sizeof(copy));
+	b.desc.VS = { copy, sizeof(copy) };
+	CHECK(a.Key() == b.Key());
+}
+
+TEST_CASE(PipelineStateKey_IgnoresPadding)
+{
+	TestDesc zeros(0x00), garbage(0xCD);
+	CHECK(zeros.Key() == garbage.Key());
+	// CachedPSO doesn't change the pipeline.
+	garbage.desc.CachedPSO = { VertexShader, sizeof(VertexShader) };
+	CHECK(zeros.Key() == garbage.Key());
+}
+
+TEST_CASE(PipelineStateKey_ChangesWithTheDesc)
+{
+	const uint64_t base = TestDesc().Key();
+
+	uint8_t shader[sizeof(PixelShader)];
+	memcpy(shader, PixelShader, sizeof(shader));
+	shader[sizeof(shader) - 1]++;
+	TestDesc pixelShader;
+	pixelShader.desc.PS = { shader, sizeof(shader) };
+	CHECK(pixelShader.Key() != base);
+
+	TestDesc semantic;
+	semantic.texcoord = "COLOR";
+	semantic.elements[1].SemanticName = semantic.texcoord.c_str();
+	CHECK(semantic.Key() != base);
+
+	TestDesc format;
+	format.elements[1].Format = DXGI_FORMAT_R16G16_FLOAT;
+	CHECK(format.Key() != base);
+
+	TestDesc blend;
+	blend.desc.BlendState.RenderTarget[0].BlendEnable = TRUE;
+	CHECK(blend.Key() != base);
+
+	TestDesc raster;
+	raster.desc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+	CHECK(raster.Key() != base);
+
+	TestDesc depthBias;
+	depthBias.desc.RasterizerState.SlopeScaledDepthBias = 1.0f;
+	CHECK(depthBias.Key() != base);
+
+	CHECK(TestDesc().Key(RootSignatureHash + 1) != base);
+}
+
+TEST_CASE(PipelineStateCache_CreatesOncePerKey)
+{
+	PipelineStateCache cache;
+	int creates = 0;
+	auto create = [&creates](uint64_t, PipelineStateCache::ComPtr<ID3D12PipelineState>& pipelineState) {
+		creates++;
+		pipelineState.Attach(new FakePipelineState());
+		return S_OK;
+	};
+
+	const uint64_t key = TestDesc().Key();
+	PipelineStateCache::ComPtr<ID3D12PipelineState> first, second, other;
+	CHECK(SUCCEEDED(cache.GetOrCreate(key, create, first)));
+	CHECK(SUCCEEDED(cache.GetOrCreate(key, create, second)));
+	CHECK(creates == 1);
+	CHECK(first.Get() != nullptr && first.Get() == second.Get());
+
+	CHECK(SUCCEEDED(cache.GetOrCreate(TestDesc().Key(RootSignatureHash + 1), create, other)));
+	CHECK(creates == 2);
+	CHECK(other.Get() != first.Get());
+
+	const auto stats = cache.GetStats();
+	CHECK(stats.hits == 1 && stats.misses == 2);
+	CHECK(cache.GetCount() == 2);
+}
+
+TEST_CASE(PipelineStateCache_DoesNotKeepFailedCreates)
+{
+	PipelineStateCache cache;
+	int creates = 0;
+	auto fail = [&creates](uint64_t, PipelineStateCache::ComPtr<ID3D12PipelineState>&) {
+		creates++;
+		return E_FAIL;
+	};
+
+	PipelineStateCache::ComPtr<ID3D12PipelineState> pipelineState;
+	CHECK(FAILED(cache.GetOrCreate(1, fail, pipelineState)));
+	CHECK(FAILED(cache.GetOrCreate(1, fail, pipelineState)));
+	CHECK(creates == 2);
+	CHECK(cache.GetCount() == 0);
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include "Test.h"
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Packets with random keys of the given width, each pointing at its push index.
+std::vector<RenderPacket> MakePackets(size_t count, uint64_t keyMask, unsigned seed)
+{
+	std::mt19937_64 random(seed);
+	std::vector<RenderPacket> packets(count);
+	for (size_t i = 0; i < count; i++)
+		packets[i] = { random() & keyMask, uint32_t(i) };
+	return packets;
+}
+
+bool SameAsStableSort(std::vector<RenderPacket> packets, uint32_t threadCount)
+{
+	auto expected = packets;
+	std::stable_sort(expected.begin(), expected.end(), [](const RenderPacket& a, const RenderPacket& b) { return a.key < b.key; });
+
+	std::vector<RenderPacket> scratch(packets.size());
+	if (threadCount > 1)
+		ParallelRadixSort(packets.data(), scratch.data(), packets.size(), threadCount);
+	else
+		RadixSort(packets.data(), scratch.data(), packets.size());
+
+	return std::equal(packets.begin(), packets.end(), expected.begin(),
+		[](const RenderPacket& a, const RenderPacket& b) { return a.key == b.key && a.draw == b.draw; });
+}
+
+} // namespace
+
+TEST_CASE(RadixSort_MatchesStableSort)
+{
+	CHECK(SameAsStableSort(MakePackets(0, ~0ull, 1), 1));
+	CHECK(SameAsStableSort(MakePackets(1, ~0ull, 1), 1));
+	CHECK(SameAsStableSort(MakePackets(1000, ~0ull, 2), 1));
+	// Few distinct keys test the stability, narrow keys the skipped passes.
+	CHECK(SameAsStableSort(MakePackets(1000, 0xF, 3), 1));
+	CHECK(SameAsStableSort(MakePackets(1000, 0xFF00000000000000ull, 4), 1));
+}
+
+TEST_CASE(ParallelRadixSort_MatchesStableSort)
+{
+	// Large enough to be split over the threads.
+	CHECK(SameAsStableSort(MakePackets(100000, ~0ull, 5), 4));
+	CHECK(SameAsStableSort(MakePackets(100000, 0xFF, 6), 3));
+	CHECK(SameAsStableSort(MakePackets(100000, 0, 7), 4));
+	// Small counts fall back to the calling thread.
+	CHECK(SameAsStableSort(MakePackets(100, ~0ull, 8), 8));
+}
+
+TEST_CASE(RenderSortKey_OrdersOpaqueFrontToBackAndTransparentBackToFront)
+{
+	using namespace RenderSortKey;
+	CHECK(MakeOpaque(0, 0, 0, 1.0f) < MakeOpaque(0, 0, 0, 2.0f));
+	CHECK(MakeOpaque(0, 0, 0, 100.0f) < MakeOpaque(0, 0, 1, 1.0f));
+	CHECK(MakeOpaque(0, 0, 0, -1.0f) == MakeOpaque(0, 0, 0, 0.0f));
+	CHECK(MakeTransparent(1, 0, 0, 2.0f) < MakeTransparent(1, 0, 0, 1.0f));
+	CHECK(MakeOpaque(1, 0, 0, 100.0f) < MakeTransparent(2, 0, 0, 100.0f));
+	CHECK(GetPass(MakeTransparent(2, 5, 7, 3.0f)) == 2);
+	CHECK(GetOpaqueMaterial(MakeOpaque(3, 4, 123456, 7.0f)) == 123456);
+	CHECK(GetOpaqueMaterial(MakeOpaque(0, 0, (1u << MaterialBits) + 5, 7.0f)) == 5);
+}
+
+TEST_CASE(RenderQueue_SubmitsDrawsInKeyOrder)
+{
+	RenderQueue<int> queue;
+	queue.Push(30, 3);
+	queue.Push(10, 1);
+	queue.Push(20, 2);
+	queue.Push(10, 4);
+	queue.Sort();
+
+	std::vector<int> draws;
+	std::vector<uint64_t> keys;
+	queue.Submit([&](uint64_t key, int draw) {
+		keys.push_back(key);
+		draws.push_back(draw);
+	});
+	CHECK((draws == std::vector<int>{ 1, 4, 2, 3 }));
+	CHECK((keys == std::vector<uint64_t>{ 10, 10, 20, 30 }));
+
+	queue.Clear();
+	CHECK(queue.GetCount() == 0);
+}
\ No newline at end of file
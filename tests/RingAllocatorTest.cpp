@@ -0,0 +1,117 @@
+#include "Test.h"
+#include "RingAllocator.h"
+
+#include <deque>
+
+namespace {
+
+// Fence of a simulated GPU which completes the frames in submission order when asked to.
+struct SimulatedFence {
+	uint64_t nextValue = 1;
+	uint64_t completedValue = 0;
+
+	uint64_t Signal() { return nextValue++; }
+	void CompleteUpTo(uint64_t value) { completedValue = value; }
+};
+
+} // namespace
+
+TEST_CASE(RingAllocator_AllocatesAlignedRangesInOrder)
+{
+	RingAllocator ring(1024);
+	CHECK(ring.Allocate(10) == 0);
+	CHECK(ring.Allocate(16, 256) == 256);
+	CHECK(ring.GetUsedSize() == 256 + 16);
+	CHECK(ring.Allocate(0) == RingAllocator::InvalidOffset);
+	CHECK(ring.Allocate(2048) == RingAllocator::InvalidOffset);
+}
+
+TEST_CASE(RingAllocator_ReclaimsFramesByFenceValue)
+{
+	SimulatedFence fence;
+	RingAllocator ring(1024);
+
+	CHECK(ring.Allocate(400) == 0);
+	const auto frame0 = fence.Signal();
+	ring.FinishFrame(frame0);
+	CHECK(ring.Allocate(400) == 400);
+	const auto frame1 = fence.Signal();
+	ring.FinishFrame(frame1);
+
+	// Both frames are in flight, only 224 bytes remain at the end.
+	CHECK(ring.Allocate(400) == RingAllocator::InvalidOffset);
+
+	// Retiring a value not reached yet keeps everything.
+	ring.Retire(fence.completedValue);
+	CHECK(ring.GetUsedSize() == 800);
+
+	// The first frame completes: the allocation wraps to the start.
+	fence.CompleteUpTo(frame0);
+	ring.Retire(fence.completedValue);
+	CHECK(ring.GetUsedSize() == 400);
+	CHECK(ring.Allocate(300) == 0);
+	// Skipped tail [800, 1024) is owned by the current frame.
+	CHECK(ring.GetUsedSize() == 400 + 224 + 300);
+	CHECK(ring.Allocate(200) == RingAllocator::InvalidOffset);
+	ring.FinishFrame(fence.Signal());
+}
+
+TEST_CASE(RingAllocator_DrainedRingRestartsAtZero)
+{
+	SimulatedFence fence;
+	RingAllocator ring(1024);
+
+	CHECK(ring.Allocate(600) == 0);
+	ring.FinishFrame(fence.Signal());
+	fence.CompleteUpTo(fence.nextValue - 1);
+	ring.Retire(fence.completedValue);
+	CHECK(ring.GetUsedSize() == 0);
+
+	// The ring is empty, the whole size is available in one range.
+	CHECK(ring.Allocate(1024) == 0);
+	CHECK(ring.GetUsedSize() == 1024);
+	CHECK(ring.Allocate(1) == RingAllocator::InvalidOffset);
+}
+
+TEST_CASE(RingAllocator_SimulatedFramesNeverOverlap)
+{
+	const uint64_t ringSize = 4096;
+	const uint64_t framesInFlight = 3;
+	SimulatedFence fence;
+	RingAllocator ring(ringSize);
+
+	struct Range { uint64_t offset, size, fenceValue; };
+	std::deque<Range> live;
+	uint64_t failures = 0;
+
+	for (uint64_t frame = 0; frame < 1000; ++frame) {
+		// The GPU completes the frame submitted framesInFlight frames ago.
+		if (fence.nextValue > framesInFlight) {
+			fence.CompleteUpTo(fence.nextValue - framesInFlight);
+		}
+		ring.Retire(fence.completedValue);
+		while (!live.empty() && live.front().fenceValue <= fence.completedValue) {
+			live.pop_front();
+		}
+
+		const uint64_t value = fence.nextValue;
+		for (uint64_t i = 0; i < 1 + frame % 5; ++i) {
+			const uint64_t size = 16 + (frame * 37 + i * 101) % 300;
+			const uint64_t offset = ring.Allocate(size, 16);
+			if (offset == RingAllocator::InvalidOffset) {
+				++failures;
+				continue;
+			}
+			CHECK(offset % 16 == 0);
+			CHECK(offset + size <= ringSize);
+			for (const auto& range : live) {
+				CHECK(offset + size <= range.offset || range.offset + range.size <= offset);
+			}
+			live.push_back({ offset, size, value });
+		}
+		ring.FinishFrame(fence.Signal());
+	}
+
+	// At most 5 * 316 bytes per frame and 3 frames in flight fit in the ring.
+	CHECK(failures == 0);
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "ShaderCompiler.h"
+#include "util.h"
+
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+// Time to get the sample shaders at startup, compiled by DXC with an empty disk cache (cold)
+// and loaded from the cache written by the previous run (warm). Each run uses a new ShaderCompiler
+// like a new process would. Needs DXC, so it is only built on Windows.
+namespace {
+	const wchar_t* CacheDirectory = L"ShaderCacheBenchmark";
+	const int Runs = 5;
+
+	struct Shader {
+		const wchar_t* fileName;
+		const wchar_t* profile;
+		std::vector<ShaderDefine> defines;
+	};
+
+	double Milliseconds(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// Compile every shader with a new compiler and return the time it took.
+	double CompileAll(const std::vector<Shader>& shaders)
+	{
+		using namespace std::experimental::filesystem;
+		const auto root = path(SAMPLES_DIR);
+
+		const auto start = std::chrono::steady_clock::now();
+		ShaderCompiler compiler(CacheDirectory);
+		for (const auto& shader : shaders)
+		{
+			ShaderCompiler::ComPtr<ID3DBlob> shaderBlob, errorBlob;
+			const auto fileName = (root / shader.fileName).wstring();
+			if (FAILED(compiler.CompileFromFile(fileName, L"main", shader.profile, shader.defines, shaderBlob, errorBlob)))
+				throw std::runtime_error("Failed CompileFromFile");
+		}
+		return Milliseconds(start);
+	}
+}
+
+int main()
+{
+	using namespace std::experimental::filesystem;
+
+	const std::vector<Shader> shaders = {
+		{ L"Triangle/VertexShader.hlsl", L"vs_6_0", {} },
+		{ L"Triangle/PixelShader.hlsl", L"ps_6_0", {} },
+		{ L"HelloTriangle/VertexShader.hlsl", L"vs_6_0", {} },
+		{ L"HelloTriangle/PixelShader.hlsl", L"ps_6_0", {} },
+		{ L"TexturedCube/VertexShader.hlsl", L"vs_6_0", {} },
+		{ L"TexturedCube/PixelShader.hlsl", L"ps_6_0", { { L"USE_VERTEX_COLOR", L"0" } } },
+		{ L"TexturedCube/PixelShader.hlsl", L"ps_6_0", { { L"USE_VERTEX_COLOR", L"1" } } },
+	};
+
+	double cold = 0.0;
+	for (int run = 0; run < Runs; run++)
+	{
+		std::error_code ec;
+		remove_all(path(CacheDirectory), ec);
+		cold += CompileAll(shaders);
+	}
+	// The last cold run has filled the cache.
+	double warm = 0.0;
+	for (int run = 0; run < Runs; run++)
+		warm += CompileAll(shaders);
+	cold /= Runs;
+	warm /= Runs;
+
+	std::printf("%10s %12s %12s %10s\n", "shaders", "cold(ms)", "warm(ms)", "speedup");
+	std::printf("%10zu %12.3f %12.3f %9.1fx\n", shaders.size(), cold, warm, cold / warm);
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "ShaderCompileService.h"
+#include "util.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Time to compile a corpus of shaders through ShaderCompileService with 1 to N workers, N being
+// the hardware threads. The corpus is the HLSL files of the samples, each compiled as several variants
+// whose unused define only changes the cache key. Every worker count starts with an empty cache,
+// so every shader is compiled by DXC. Needs DXC, so it is only built on Windows.
+namespace {
+	const wchar_t* CacheDirectory = L"ShaderCompileBenchmark";
+	const int VariantCount = 16;
+
+	std::vector<ShaderCompileJob> MakeCorpus()
+	{
+		using namespace std::experimental::filesystem;
+		const auto root = path(SAMPLES_DIR);
+
+		const struct { const wchar_t* fileName; const wchar_t* profile; } shaders[] = {
+			{ L"Triangle/VertexShader.hlsl", L"vs_6_0" },
+			{ L"Triangle/PixelShader.hlsl", L"ps_6_0" },
+			{ L"HelloTriangle/VertexShader.hlsl", L"vs_6_0" },
+			{ L"HelloTriangle/PixelShader.hlsl", L"ps_6_0" },
+			{ L"TexturedCube/VertexShader.hlsl", L"vs_6_0" },
+			{ L"TexturedCube/PixelShader.hlsl", L"ps_6_0" },
+		};
+		std::vector<ShaderCompileJob> jobs;
+		for (int variant = 0; variant < VariantCount; variant++)
+		{
+			for (const auto& shader : shaders)
+			{
+				ShaderCompileJob job;
+				job.fileName = (root / shader.fileName).wstring();
+				job.profile = shader.profile;
+				job.defines = { { L"BENCHMARK_VARIANT", std::to_wstring(variant) }, { L"USE_VERTEX_COLOR", std::to_wstring(variant & 1) } };
+				jobs.push_back(job);
+			}
+		}
+		return jobs;
+	}
+
+	// Compile the corpus on workerCount workers and return the time it took, including the worker startup.
+	double CompileAll(const std::vector<ShaderCompileJob>& jobs, UINT workerCount)
+	{
+		using namespace std::experimental::filesystem;
+		std::error_code ec;
+		remove_all(path(CacheDirectory), ec);
+
+		const auto start = std::chrono::steady_clock::now();
+		{
+			ShaderCompileService service(workerCount, CacheDirectory);
+			for (auto& future : service.Submit(jobs))
+			{
+				if (FAILED(future.get().hr))
+					throw std::runtime_error("Failed CompileFromFile");
+			}
+		}
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+int main()
+{
+	const auto jobs = MakeCorpus();
+	const UINT maxWorkers = std::max(1u, std::thread::hardware_concurrency());
+
+	std::printf("%zu shaders, %u hardware threads\n", jobs.size(), maxWorkers);
+	std::printf("%10s %12s %12s %10s\n", "workers", "time(ms)", "shaders/s", "speedup");
+	double single = 0.0;
+	for (UINT workers = 1; workers <= maxWorkers; workers++)
+	{
+		const double ms = CompileAll(jobs, workers);
+		if (workers == 1)
+			single = ms;
+		std::printf("%10u %12.1f %12.1f %9.2fx\n", workers, ms, jobs.size() * 1000.0 / ms, single / ms);
+	}
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "Test.h"
+#include "StatefulCommandList.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+// Command list which records the names of the calls forwarded to it.
+struct FakeCommandList {
+	std::vector<std::string> calls;
+
+	void SetPipelineState(ID3D12PipelineState*) { calls.push_back("SetPipelineState"); }
+	void SetGraphicsRootSignature(ID3D12RootSignature*) { calls.push_back("SetGraphicsRootSignature"); }
+	void RSSetViewports(UINT, const D3D12_VIEWPORT*) { calls.push_back("RSSetViewports"); }
+	void RSSetScissorRects(UINT, const D3D12_RECT*) { calls.push_back("RSSetScissorRects"); }
+	void SetDescriptorHeaps(UINT, ID3D12DescriptorHeap* const*) { calls.push_back("SetDescriptorHeaps"); }
+	void IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY) { calls.push_back("IASetPrimitiveTopology"); }
+	void IASetVertexBuffers(UINT, UINT, const D3D12_VERTEX_BUFFER_VIEW*) { calls.push_back("IASetVertexBuffers"); }
+	void IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW*) { calls.push_back("IASetIndexBuffer"); }
+	void SetGraphicsRootConstantBufferView(UINT, D3D12_GPU_VIRTUAL_ADDRESS) { calls.push_back("SetGraphicsRootConstantBufferView"); }
+	void SetGraphicsRootShaderResourceView(UINT, D3D12_GPU_VIRTUAL_ADDRESS) { calls.push_back("SetGraphicsRootShaderResourceView"); }
+	void SetGraphicsRootUnorderedAccessView(UINT, D3D12_GPU_VIRTUAL_ADDRESS) { calls.push_back("SetGraphicsRootUnorderedAccessView"); }
+	void SetGraphicsRootDescriptorTable(UINT, D3D12_GPU_DESCRIPTOR_HANDLE) { calls.push_back("SetGraphicsRootDescriptorTable"); }
+	void SetGraphicsRoot32BitConstants(UINT, UINT, const void*, UINT) { calls.push_back("SetGraphicsRoot32BitConstants"); }
+	void DrawInstanced(UINT, UINT, UINT, UINT) { calls.push_back("DrawInstanced"); }
+	void DrawIndexedInstanced(UINT, UINT, UINT, INT, UINT) { calls.push_back("DrawIndexedInstanced"); }
+	void ExecuteIndirect(ID3D12CommandSignature*, UINT, ID3D12Resource*, UINT64, ID3D12Resource*, UINT64) { calls.push_back("ExecuteIndirect"); }
+
+	size_t Count(const std::string& name) const
+	{
+		size_t count = 0;
+		for (const auto& call : calls)
+			count += call == name;
+		return count;
+	}
+};
+
+ID3D12PipelineState* FakePipeline(uintptr_t id) { return reinterpret_cast<ID3D12PipelineState*>(id); }
+ID3D12RootSignature* FakeRootSignature(uintptr_t id) { return reinterpret_cast<ID3D12RootSignature*>(id); }
+ID3D12DescriptorHeap* FakeHeap(uintptr_t id) { return reinterpret_cast<ID3D12DescriptorHeap*>(id); }
+
+} // namespace
+
+TEST_CASE(StatefulCommandList_ElidesRedundantState)
+{
+	FakeCommandList list;
+	StatefulCommandList<FakeCommandList> command;
+	command.Begin(&list);
+
+	command.SetPipelineState(FakePipeline(1));
+	command.SetPipelineState(FakePipeline(1));
+	command.SetGraphicsRootSignature(FakeRootSignature(1));
+	command.SetGraphicsRootDescriptorTable(0, { 100 });
+	command.SetGraphicsRootDescriptorTable(0, { 100 });
+	command.SetGraphicsRootDescriptorTable(0, { 200 });
+	CHECK(list.Count("SetPipelineState") == 1);
+	CHECK(list.Count("SetGraphicsRootDescriptorTable") == 2);
+	CHECK(command.GetStats().elided == 2);
+
+	// A new root signature resets the root arguments.
+	command.SetGraphicsRootSignature(FakeRootSignature(2));
+	command.SetGraphicsRootDescriptorTable(0, { 200 });
+	CHECK(list.Count("SetGraphicsRootDescriptorTable") == 3);
+}
+
+TEST_CASE(StatefulCommandList_HeapChangeForgetsTables)
+{
+	FakeCommandList list;
+	StatefulCommandList<FakeCommandList> command;
+	command.Begin(&list);
+
+	ID3D12DescriptorHeap* heaps[] = { FakeHeap(1), FakeHeap(2) };
+	command.SetDescriptorHeaps(2, heaps);
+	command.SetGraphicsRootSignature(FakeRootSignature(1));
+	command.SetGraphicsRootDescriptorTable(0, { 100 });
+	command.SetGraphicsRootConstantBufferView(1, 0x1000);
+
+	// Same heaps again: nothing is forwarded and the table stays bound.
+	command.SetDescriptorHeaps(2, heaps);
+	command.SetGraphicsRootDescriptorTable(0, { 100 });
+	CHECK(list.Count("SetDescriptorHeaps") == 1);
+	CHECK(list.Count("SetGraphicsRootDescriptorTable") == 1);
+
+	// Other heaps: the same handle is set again, root descriptors don't depend on the heaps.
+	ID3D12DescriptorHeap* otherHeaps[] = { FakeHeap(3), FakeHeap(2) };
+	command.SetDescriptorHeaps(2, otherHeaps);
+	command.SetGraphicsRootDescriptorTable(0, { 100 });
+	command.SetGraphicsRootConstantBufferView(1, 0x1000);
+	CHECK(list.Count("SetDescriptorHeaps") == 2);
+	CHECK(list.Count("SetGraphicsRootDescriptorTable") == 2);
+	CHECK(list.Count("SetGraphicsRootConstantBufferView") == 1);
+}
+
+TEST_CASE(StatefulCommandList_ExecuteIndirectForgetsBuffers)
+{
+	FakeCommandList list;
+	StatefulCommandList<FakeCommandList> command;
+	command.Begin(&list);
+
+	const D3D12_VERTEX_BUFFER_VIEW vertexBuffer = { 0x2000, 64, 16 };
+	const D3D12_INDEX_BUFFER_VIEW indexBuffer = { 0x3000, 12, DXGI_FORMAT_R32_UINT };
+	command.IASetVertexBuffers(0, 1, &vertexBuffer);
+	command.IASetIndexBuffer(&indexBuffer);
+	command.ExecuteIndirect(nullptr, 1, nullptr, 0);
+	command.IASetVertexBuffers(0, 1, &vertexBuffer);
+	command.IASetIndexBuffer(&indexBuffer);
+	CHECK(list.Count("IASetVertexBuffers") == 2);
+	CHECK(list.Count("IASetIndexBuffer") == 2);
+	CHECK(command.GetStats().draws == 1);
+}
\ No newline at end of file
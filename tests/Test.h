@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+// Minimal self registering test cases for the console test executables.
+namespace Test {
+
+struct Case {
+	const char* name;
+	std::function<void()> func;
+};
+
+inline std::vector<Case>& GetCases()
+{
+	static std::vector<Case> cases;
+	return cases;
+}
+
+inline int& GetFailureCount()
+{
+	static int count = 0;
+	return count;
+}
+
+inline void Check(bool passed, const char* file, int line, const char* expr)
+{
+	if (!passed) {
+		std::printf("  %s(%d): CHECK(%s) failed\n", file, line, expr);
+		++GetFailureCount();
+	}
+}
+
+struct Registrar {
+	Registrar(const char* name, std::function<void()> func) { GetCases().push_back({ name, std::move(func) }); }
+};
+
+} // namespace Test
+
+#define TEST_CONCAT_IMPL(a, b) a##b
+#define TEST_CONCAT(a, b) TEST_CONCAT_IMPL(a, b)
+
+#define TEST_CASE(name)                                                       \
+	static void TEST_CONCAT(TestFunc_, name)();                               \
+	static Test::Registrar TEST_CONCAT(TestRegistrar_, name)(#name, TEST_CONCAT(TestFunc_, name)); \
+	static void TEST_CONCAT(TestFunc_, name)()
+
+#define CHECK(expr) Test::Check(!!(expr), __FILE__, __LINE__, #expr)
\ No newline at end of file
@@ -0,0 +1,31 @@
+#include "Test.h"
+
+#include <cstring>
+#include <exception>
+
+// Usage: UtilTests [name filter]
+int main(int argc, char** argv)
+{
+	const char* filter = argc > 1 ? argv[1] : nullptr;
+
+	int run = 0;
+	for (const auto& test : Test::GetCases()) {
+		if (filter && !std::strstr(test.name, filter)) {
+			continue;
+		}
+		std::printf("[ RUN  ] %s\n", test.name);
+		const int failures = Test::GetFailureCount();
+		try {
+			test.func();
+		}
+		catch (const std::exception& e) {
+			std::printf("  unexpected exception: %s\n", e.what());
+			++Test::GetFailureCount();
+		}
+		std::printf("[ %s ] %s\n", failures == Test::GetFailureCount() ? " OK " : "FAIL", test.name);
+		++run;
+	}
+
+	std::printf("%d test(s) run, %d check(s) failed\n", run, Test::GetFailureCount());
+	return Test::GetFailureCount() == 0 && run > 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+struct BuddyAllocatorStats {
+	uint64_t size = 0;
+	uint64_t requestedBytes = 0;	// Sum of the sizes asked by callers.
+	uint64_t allocatedBytes = 0;	// Sum of the block sizes handed out.
+	uint64_t freeBytes = 0;
+	uint64_t largestFreeBlock = 0;
+	uint64_t freeBlockCount = 0;
+	uint64_t allocationCount = 0;
+
+	// Memory lost by rounding up to power of two blocks.
+	uint64_t InternalWaste() const { return allocatedBytes - requestedBytes; }
+	// 0 when all free memory is one block, close to 1 when it is split into many small blocks.
+	double Fragmentation() const { return freeBytes > 0 ? 1.0 - double(largestFreeBlock) / double(freeBytes) : 0.0; }
+};
+
+// Buddy allocator over [0, size) offsets. It only manages offsets, so it works without a device.
+// size / minBlockSize must be a power of two.
+class BuddyAllocator {
+public:
+	static const uint64_t InvalidOffset = ~0ull;
+
+	BuddyAllocator() : m_size(0), m_minBlockSize(0), m_maxOrder(0) {}
+	BuddyAllocator(uint64_t size, uint64_t minBlockSize) { Reset(size, minBlockSize); }
+
+	void Reset(uint64_t size, uint64_t minBlockSize)
+	{
+		m_size = size;
+		m_minBlockSize = minBlockSize;
+		m_maxOrder = OrderOf(size);
+		m_freeBlocks.assign(m_maxOrder + 1, {});
+		m_freeBlocks[m_maxOrder].insert(0);
+		m_allocations.clear();
+		m_stats = BuddyAllocatorStats();
+		m_stats.size = size;
+		m_stats.freeBytes = size;
+	}
+
+	// Blocks are naturally aligned to their size, so any power of two alignment up to the size is honored.
+	uint64_t Allocate(uint64_t size, uint64_t alignment = 1)
+	{
+		const uint64_t blockSize = size > alignment ? size : alignment;
+		if (size == 0 || blockSize > m_size)
+			return InvalidOffset;
+
+		const uint32_t order = OrderOf(blockSize);
+		uint32_t found = order;
+		while (found <= m_maxOrder && m_freeBlocks[found].empty())
+			found++;
+		if (found > m_maxOrder)
+			return InvalidOffset;
+
+		uint64_t offset = *m_freeBlocks[found].begin();
+		m_freeBlocks[found].erase(m_freeBlocks[found].begin());
+
+		// Split down to the requested order, keeping the upper halves free.
+		while (found > order)
+		{
+			found--;
+			m_freeBlocks[found].insert(offset + BlockSize(found));
+		}
+
+		m_allocations[offset] = { order, size };
+		m_stats.requestedBytes += size;
+		m_stats.allocatedBytes += BlockSize(order);
+		m_stats.allocationCount++;
+		return offset;
+	}
+
+	void Free(uint64_t offset)
+	{
+		auto it = m_allocations.find(offset);
+		if (it == m_allocations.end())
+			return;
+		uint32_t order = it->second.order;
+		m_stats.requestedBytes -= it->second.size;
+		m_stats.allocatedBytes -= BlockSize(order);
+		m_stats.allocationCount--;
+		m_allocations.erase(it);
+
+		// Merge with the buddy while it is free.
+		while (order < m_maxOrder)
+		{
+			const uint64_t buddy = offset ^ BlockSize(order);
+			auto buddyIt = m_freeBlocks[order].find(buddy);
+			if (buddyIt == m_freeBlocks[order].end())
+				break;
+			m_freeBlocks[order].erase(buddyIt);
+			offset = offset < buddy ? offset : buddy;
+			order++;
+		}
+		m_freeBlocks[order].insert(offset);
+	}
+
+	bool IsEmpty() const { return m_allocations.empty(); }
+	uint64_t GetSize() const { return m_size; }
+
+	const BuddyAllocatorStats& GetStats()
+	{
+		m_stats.freeBytes = m_size - m_stats.allocatedBytes;
+		m_stats.freeBlockCount = 0;
+		m_stats.largestFreeBlock = 0;
+		for (uint32_t order = 0; order <= m_maxOrder; order++)
+		{
+			m_stats.freeBlockCount += m_freeBlocks[order].size();
+			if (!m_freeBlocks[order].empty())
+				m_stats.largestFreeBlock = BlockSize(order);
+		}
+		return m_stats;
+	}
+
+private:
+	struct Allocation {
+		uint32_t order;
+		uint64_t size;
+	};
+
+	uint64_t BlockSize(uint32_t order) const { return m_minBlockSize << order; }
+	uint32_t OrderOf(uint64_t size) const
+	{
+		uint32_t order = 0;
+		while (BlockSize(order) < size)
+			order++;
+		return order;
+	}
+
+	uint64_t m_size;
+	uint64_t m_minBlockSize;
+	uint32_t m_maxOrder;
+	std::vector<std::unordered_set<uint64_t>> m_freeBlocks; // Free block offsets of each order.
+	std::unordered_map<uint64_t, Allocation> m_allocations;
+	BuddyAllocatorStats m_stats;
+};
\ No newline at end of file
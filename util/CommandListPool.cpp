@@ -0,0 +1,89 @@
+#include "CommandListPool.h"
+#include <stdexcept>
+
+void CommandListPool::Initialize(ID3D12Device* device, ID3D12Fence* fence)
+{
+	m_device = device;
+	m_fence = fence;
+}
+
+PooledCommandList CommandListPool::Acquire(D3D12_COMMAND_LIST_TYPE type)
+{
+	PooledCommandList list;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto& pool = GetPool(type);
+		if (!pool.returned.empty() && pool.returned.front().fenceValue <= m_fence->GetCompletedValue())
+		{
+			list = std::move(pool.returned.front().list);
+			pool.returned.pop_front();
+		}
+		else
+		{
+			pool.created++;
+		}
+	}
+
+	if (list.allocator)
+	{
+		list.allocator->Reset();
+		list.commandList->Reset(list.allocator.Get(), nullptr);
+		return list;
+	}
+
+	HRESULT hr;
+	list.type = type;
+	hr = m_device->CreateCommandAllocator(type, IID_PPV_ARGS(&list.allocator));
+	if (FAILED(hr))
+	{
+		throw std::runtime_error("Failed CreateCommandAllocator(CommandListPool)");
+	}
+	// Created lists are open, as the reused ones.
+	hr = m_device->CreateCommandList(0, type, list.allocator.Get(), nullptr, IID_PPV_ARGS(&list.commandList));
+	if (FAILED(hr))
+	{
+		throw std::runtime_error("Failed CreateCommandList(CommandListPool)");
+	}
+	return list;
+}
+
+void CommandListPool::Release(PooledCommandList& list, UINT64 fenceValue)
+{
+	if (!list.allocator)
+		return;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto& returned = GetPool(list.type).returned;
+	// A list returned unsubmitted goes first, since it is reusable now.
+	if (fenceValue == 0)
+		returned.push_front({ fenceValue, std::move(list) });
+	else
+		returned.push_back({ fenceValue, std::move(list) });
+	list = PooledCommandList();
+}
+
+UINT CommandListPool::GetCreatedCount(D3D12_COMMAND_LIST_TYPE type) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return GetPool(type).created;
+}
+
+UINT CommandListPool::GetPooledCount(D3D12_COMMAND_LIST_TYPE type) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return UINT(GetPool(type).returned.size());
+}
+
+CommandListPool::TypePool& CommandListPool::GetPool(D3D12_COMMAND_LIST_TYPE type)
+{
+	if (UINT(type) >= TypeCount)
+		throw std::runtime_error("Unsupported command list type in CommandListPool.");
+	return m_pools[type];
+}
+
+const CommandListPool::TypePool& CommandListPool::GetPool(D3D12_COMMAND_LIST_TYPE type) const
+{
+	if (UINT(type) >= TypeCount)
+		throw std::runtime_error("Unsupported command list type in CommandListPool.");
+	return m_pools[type];
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <d3d12.h>
+
+#include <wrl.h>
+#include <deque>
+#include <mutex>
+
+// Command allocator and the list recording into it. They are handed out and returned together.
+struct PooledCommandList {
+	Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator;
+	Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> commandList;
+	D3D12_COMMAND_LIST_TYPE type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+
+	ID3D12GraphicsCommandList* operator->() const { return commandList.Get(); }
+};
+
+// Recycles command allocators and lists per list type.
+// A returned pair is tagged with the fence value of its submission and handed out again
+// only after the fence has reached it, so at steady state no API object is created.
+class CommandListPool {
+public:
+	template<class T>
+	using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+	// Fence values given to Release() are those of fence.
+	void Initialize(ID3D12Device* device, ID3D12Fence* fence);
+
+	// An open list of the type. Created when no returned pair has completed yet.
+	PooledCommandList Acquire(D3D12_COMMAND_LIST_TYPE type = D3D12_COMMAND_LIST_TYPE_DIRECT);
+	// Return a closed list after its submission, which signaled fenceValue.
+	// A list which was never submitted can be returned with 0.
+	void Release(PooledCommandList& list, UINT64 fenceValue);
+
+	UINT GetCreatedCount(D3D12_COMMAND_LIST_TYPE type) const;
+	UINT GetPooledCount(D3D12_COMMAND_LIST_TYPE type) const;
+
+private:
+	static const UINT TypeCount = D3D12_COMMAND_LIST_TYPE_COPY + 1;
+
+	struct ReturnedList {
+		UINT64 fenceValue;
+		PooledCommandList list;
+	};
+
+	struct TypePool {
+		// In the order of return, which is also the order of the fence values.
+		std::deque<ReturnedList> returned;
+		UINT created = 0;
+	};
+
+	TypePool& GetPool(D3D12_COMMAND_LIST_TYPE type);
+	const TypePool& GetPool(D3D12_COMMAND_LIST_TYPE type) const;
+
+	ComPtr<ID3D12Device> m_device;
+	ComPtr<ID3D12Fence> m_fence;
+	TypePool m_pools[TypeCount];
+	mutable std::mutex m_mutex;
+};
\ No newline at end of file
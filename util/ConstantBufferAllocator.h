@@ -0,0 +1,31 @@
+#pragma once
+
+#include "UploadRingBuffer.h"
+#include <stdexcept>
+
+// Hands out 256 bytes aligned slices of one persistently mapped buffer for per draw constants.
+// Bind the returned address with SetGraphicsRootConstantBufferView, no CBV descriptor is needed.
+class ConstantBufferAllocator {
+public:
+	void Initialize(ID3D12Device* device, UINT64 size) { m_ring.Initialize(device, size); }
+
+	D3D12_GPU_VIRTUAL_ADDRESS Allocate(const void* data, UINT64 size)
+	{
+		UploadAllocation allocation;
+		if (!m_ring.Upload(data, size, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, allocation))
+		{
+			throw std::runtime_error("Constant buffer ring is full.");
+		}
+		return allocation.gpuAddress;
+	}
+	template<class T>
+	D3D12_GPU_VIRTUAL_ADDRESS Allocate(const T& data) { return Allocate(&data, sizeof(T)); }
+
+	void FinishFrame(UINT64 fenceValue) { m_ring.FinishFrame(fenceValue); }
+	void Retire(UINT64 completedValue) { m_ring.Retire(completedValue); }
+
+	UINT64 GetUsedSize() const { return m_ring.GetUsedSize(); }
+
+private:
+	UploadRingBuffer m_ring;
+};
\ No newline at end of file
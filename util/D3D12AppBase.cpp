@@ -1,29 +1,46 @@
 #include "D3D12AppBase.h"
 #include <exception>
 #include <fstream>
-
-#if _MSC_VER > 1922
-#define _SILENCE_EXPERIMENTAL_FILESYSTEM_DEPRECATION_WARNING
-#endif
-#include <experimental/filesystem>
-
-// For DirectX Shader Compiler. 
-#include <dxcapi.h>
-#pragma comment(lib, "dxcompiler.lib")
+#include <algorithm>
 
 using namespace Microsoft::WRL;
 
 D3D12AppBase::D3D12AppBase()
 {
 	m_renderTargets.resize(FrameBufferCount);
-	m_frameFenceValues.resize(FrameBufferCount);
-	m_frameIndex = 0;
+	m_framesInFlight = MinFramesInFlight;
+	m_uploadBytesPerFrame = 0;
+	m_fenceValue = 0;
+	m_backBufferIndex = 0;
 
 	m_fenceWaitEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
 }
 
 D3D12AppBase::~D3D12AppBase()
 {
+	if (m_frameFence)
+	{
+		WaitForGpu();
+	}
+	m_deferredRelease.ReleaseAll();
+}
+
+void D3D12AppBase::SetFramesInFlight(UINT count)
+{
+	if (m_device)
+	{
+		throw std::runtime_error("SetFramesInFlight must be called before Initialize.");
+	}
+	m_framesInFlight = std::min(std::max(count, MinFramesInFlight), MaxFramesInFlight);
+}
+
+void D3D12AppBase::SetUploadBytesPerFrame(UINT64 size)
+{
+	if (m_device)
+	{
+		throw std::runtime_error("SetUploadBytesPerFrame must be called before Initialize.");
+	}
+	m_uploadBytesPerFrame = size;
 }
 
 void D3D12AppBase::Initialize(HWND hWnd) {
@@ -83,6 +100,8 @@ void D3D12AppBase::Initialize(HWND hWnd) {
 	{
 		throw new std::runtime_error("D3D12CreateDevice failed.");
 	}
+	m_pipelineCache.Initialize(m_device.Get(), PipelineCacheFile);
+	m_pipelineCompileQueue.Initialize(&m_pipelineCache);
 
 	// Create command queue.
 	D3D12_COMMAND_QUEUE_DESC queueDesc{
@@ -138,55 +157,67 @@ void D3D12AppBase::Initialize(HWND hWnd) {
 	// Prepare depth buffer.
 	CreateDepthBuffer(width, height);
 
-	// Prepare the command allocator.
-	CreateCommandAllocators();
 	// Create fence for render frame Sync.
-	CreateFrameFences();
-
-	// Create command list.
-	hr = m_device->CreateCommandList(
-		0,
-		D3D12_COMMAND_LIST_TYPE_DIRECT,
-		m_commandAllocators[0].Get(),
-		nullptr,
-		IID_PPV_ARGS(&m_commandList)
-	);
-	m_commandList->Close();
+	CreateFrameFence();
+	m_framePacer.Initialize(&m_queueFence, m_framesInFlight);
+	// Command lists of every submission are recycled by the frame fence.
+	m_commandListPool.Initialize(m_device.Get(), m_frameFence.Get());
+	m_commandRecorder.Initialize(&m_commandListPool);
+	// Prepare the upload memory for transient data.
+	m_uploadRing.Initialize(m_device.Get(), std::max(UploadRingSize, m_uploadBytesPerFrame * (m_framesInFlight + 1)));
+	m_heapAllocator.Initialize(m_device.Get());
+	m_staticUploader.Initialize(m_device.Get(), &m_heapAllocator, &m_resourceStates, &m_commandListPool, [this]() { return SignalFence(); });
+	m_textureUploader.Initialize(m_device.Get(), m_commandQueue.Get(), [this]() { return SignalFence(); }, &m_deferredRelease, &m_resourceStates, &m_commandListPool);
 
 	m_viewport = CD3DX12_VIEWPORT(0.0f, 0.0f, float(width), float(height));
 	m_scissorRect = CD3DX12_RECT(0, 0, LONG(width), LONG(height));
 
+	m_shaderArchive.Open(ShaderArchiveFile, CheckShaderArchiveSources);
+
 	Setup();
+	// Copy the static data created in Setup() at once.
+	FlushStaticUploads();
+	// Textures don't need CPU wait. They are executed before the first frame on the same queue.
+	m_textureUploader.Submit();
+}
+
+bool D3D12AppBase::PackShaders(const std::vector<ShaderCompileJob>& jobs)
+{
+	// The archive is opened by Initialize() and can't be replaced while it is mapped.
+	m_shaderArchive.Close();
+	return ShaderArchiveWriter::Pack(jobs, m_shaderCompileService, ShaderArchiveFile);
 }
 
 void D3D12AppBase::Terminate()
 {
 	Cleanup();
+	// Pipelines compiled in this run are loaded from the file next time.
+	m_pipelineCompileQueue.WaitIdle();
+	m_pipelineCache.Save();
 }
 
 void D3D12AppBase::Render() 
 {
-	m_frameIndex = m_swapChain->GetCurrentBackBufferIndex();
-
-	m_commandAllocators[m_frameIndex]->Reset();
-	m_commandList->Reset(
-		m_commandAllocators[m_frameIndex].Get(),
-		nullptr
-	);
+	m_backBufferIndex = m_swapChain->GetCurrentBackBufferIndex();
+	const auto completedValue = m_frameFence->GetCompletedValue();
+	m_uploadRing.Retire(completedValue);
+	m_descriptorRing.Retire(completedValue);
+	m_samplerRing.Retire(completedValue);
+	m_textureUploader.Submit();
+	m_textureUploader.Retire(completedValue);
+	m_deferredRelease.Drain(completedValue);
+
+	// Allocators of the frames which have completed are reused.
+	m_frameCommandList = m_commandListPool.Acquire(D3D12_COMMAND_LIST_TYPE_DIRECT);
+	m_commandList = m_frameCommandList.commandList;
+	m_stateCommandList.Begin(m_commandList.Get());
 
 	// To enable render the render target from to enable display swap chain.
-	auto barrierToRT = CD3DX12_RESOURCE_BARRIER::Transition(
-		m_renderTargets[m_frameIndex].Get(),
-		D3D12_RESOURCE_STATE_PRESENT,
-		D3D12_RESOURCE_STATE_RENDER_TARGET);
-	m_commandList->ResourceBarrier(1, &barrierToRT);
-
-	CD3DX12_CPU_DESCRIPTOR_HANDLE rtv(
-		m_heapRtv->GetCPUDescriptorHandleForHeapStart(),
-		m_frameIndex, m_rtvDescriptorSize);
-	CD3DX12_CPU_DESCRIPTOR_HANDLE dsv(
-		m_heapDsv->GetCPUDescriptorHandleForHeapStart()
-	);
+	m_resourceStates.Transition(m_renderTargets[m_backBufferIndex].Get(), D3D12_RESOURCE_STATE_RENDER_TARGET);
+	m_resourceStates.Flush(m_commandList.Get());
+
+	auto rtv = m_rtvHandles[m_backBufferIndex].cpu;
+	auto dsv = m_dsvHandle.cpu;
 
 	// Clear the color buffer.
 	const float clearColor[] = { 0.1f, 0.25f, 0.5f, 0.0f }; 
@@ -200,20 +231,42 @@ void D3D12AppBase::Render()
 	// Set the output to render.
 	m_commandList->OMSetRenderTargets(1, &rtv, FALSE, &dsv);
 
+	// Set the shader visible heaps once for the whole frame.
+	ID3D12DescriptorHeap* heaps[] = {
+		m_descriptorRing.GetHeap(), m_samplerRing.GetHeap()
+	};
+	m_stateCommandList.SetDescriptorHeaps(_countof(heaps), heaps);
+
 	MakeCommand(m_commandList);
 
+	std::vector<ID3D12CommandList*> lists = { m_commandList.Get() };
+	ID3D12GraphicsCommandList* lastList = m_commandList.Get();
+	if (m_recordingJobCount > 0)
+	{
+		// Barriers queued by MakeCommand() must run before the jobs.
+		m_resourceStates.Flush(m_commandList.Get());
+		m_commandList->Close();
+
+		m_commandRecorder.Record(m_recordingJobCount, [&](UINT job, StatefulCommandList<>& command) {
+			command->OMSetRenderTargets(1, &rtv, FALSE, &dsv);
+			command.SetDescriptorHeaps(_countof(heaps), heaps);
+			MakeCommandJob(job, m_recordingJobCount, command);
+		});
+		lastList = m_commandRecorder.GetCommandList(m_recordingJobCount - 1);
+	}
+
 	// To enable to display swapchain from render target.
-	auto barrierToPresent = CD3DX12_RESOURCE_BARRIER::Transition(
-		m_renderTargets[m_frameIndex].Get(),
-		D3D12_RESOURCE_STATE_RENDER_TARGET,
-		D3D12_RESOURCE_STATE_PRESENT
-	);
-	m_commandList->ResourceBarrier(1, &barrierToPresent);
+	// Transitions queued by MakeCommand() and not flushed yet are issued together with it.
+	m_resourceStates.Transition(m_renderTargets[m_backBufferIndex].Get(), D3D12_RESOURCE_STATE_PRESENT);
+	m_resourceStates.Flush(lastList);
 
-	m_commandList->Close();
+	if (m_recordingJobCount > 0)
+		m_commandRecorder.Close(lists);
+	else
+		m_commandList->Close();
 
-	ID3D12CommandList* lists[] = { m_commandList.Get() };
-	m_commandQueue->ExecuteCommandLists(1, lists);
+	// Every list of the frame goes in one submission.
+	m_commandQueue->ExecuteCommandLists(UINT(lists.size()), lists.data());
 
 	m_swapChain->Present(1, 0);
 
@@ -222,45 +275,26 @@ void D3D12AppBase::Render()
 
 void D3D12AppBase::PrepareDescriptorHeaps()
 {
-	// Descriptor heap of RTV.
-	HRESULT hr;
-	D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc{
-		D3D12_DESCRIPTOR_HEAP_TYPE_RTV,
-		FrameBufferCount,
-		D3D12_DESCRIPTOR_HEAP_FLAG_NONE,
-		0
-	};
-	hr = m_device->CreateDescriptorHeap(&rtvHeapDesc, IID_PPV_ARGS(&m_heapRtv));
-	if (FAILED(hr))
-	{
-		throw std::runtime_error("Failed CreateDescriptorHeap(RTV)");
+	// Staging descriptor allocator of every heap type. They grow on demand.
+	for (UINT type = 0; type < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; type++) {
+		m_descriptorAllocators[type].Initialize(m_device.Get(), D3D12_DESCRIPTOR_HEAP_TYPE(type));
 	}
-	m_rtvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+	m_srvcbvDescriptorSize = m_descriptorAllocators[D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV].GetDescriptorSize();
 
-	// Descriptor heap of DSV.
-	D3D12_DESCRIPTOR_HEAP_DESC dsvHeapDesc{
-		D3D12_DESCRIPTOR_HEAP_TYPE_DSV,
-		1,
-		D3D12_DESCRIPTOR_HEAP_FLAG_NONE,
-		0
-	};
-	hr = m_device->CreateDescriptorHeap(&dsvHeapDesc, IID_PPV_ARGS(&m_heapDsv));
-	if (FAILED(hr))
-	{
-		throw std::runtime_error("Failed CreateDescriptorHeap(DSV)");
-	}
+	// Shader visible heaps to build descriptor tables per frame.
+	m_descriptorRing.Initialize(m_device.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, DescriptorRingSize);
+	m_samplerRing.Initialize(m_device.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER, SamplerRingSize);
 }
 
 void D3D12AppBase::PrepareRenderTargetView()
 {
 	// Create render target view to swapchain image.
-	CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(
-		m_heapRtv->GetCPUDescriptorHandleForHeapStart());
+	m_rtvHandles.resize(FrameBufferCount);
 	for (UINT i = 0; i < FrameBufferCount; i++) {
 		m_swapChain->GetBuffer(i, IID_PPV_ARGS(&m_renderTargets[i]));
-		m_device->CreateRenderTargetView(m_renderTargets[i].Get(), nullptr, rtvHandle);
-		// Change descriptor to reference.
-		rtvHandle.Offset(1, m_rtvDescriptorSize);
+		m_rtvHandles[i] = m_descriptorAllocators[D3D12_DESCRIPTOR_HEAP_TYPE_RTV].Allocate();
+		m_device->CreateRenderTargetView(m_renderTargets[i].Get(), nullptr, m_rtvHandles[i].cpu);
+		m_resourceStates.Register(m_renderTargets[i].Get(), D3D12_RESOURCE_STATE_PRESENT);
 	}
 }
 
@@ -294,6 +328,55 @@ ComPtr<ID3D12Resource> D3D12AppBase::CreateBuffer(UINT bufferSize, const void* i
 	return buffer;
 }
 
+bool D3D12AppBase::AllocateUpload(UINT64 size, const void* initialData, UploadAllocation& allocation, UINT64 alignment)
+{
+	if (!m_uploadRing.Allocate(size, alignment, allocation))
+		return false;
+
+	// Copy when there is assignment of initial data.
+	if (initialData != nullptr)
+	{
+		memcpy(allocation.cpuAddress, initialData, size);
+	}
+	return true;
+}
+
+ComPtr<ID3D12Resource1> D3D12AppBase::CreateStaticBuffer(UINT64 bufferSize, const void* initialData, D3D12_RESOURCE_STATES state,
+	HeapAllocation& allocation)
+{
+	return m_staticUploader.Enqueue(initialData, bufferSize, state, allocation);
+}
+
+void D3D12AppBase::FlushStaticUploads()
+{
+	if (m_staticUploader.IsEmpty())
+		return;
+
+	// A single submission and a single wait for all pending geometry.
+	WaitForFenceValue(m_staticUploader.Flush(m_commandQueue.Get()));
+	m_staticUploader.Reset();
+}
+
+ComPtr<ID3D12Resource1> D3D12AppBase::CreatePlacedResource(const D3D12_RESOURCE_DESC& desc, D3D12_HEAP_TYPE heapType,
+	D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue, HeapAllocation& allocation)
+{
+	auto resource = m_heapAllocator.CreateResource(desc, heapType, initialState, clearValue, allocation);
+	m_resourceStates.Register(resource.Get(), initialState);
+	return resource;
+}
+
+void D3D12AppBase::ReleasePlacedResource(ComPtr<ID3D12Resource1>& resource, HeapAllocation& allocation)
+{
+	m_resourceStates.Unregister(resource.Get());
+	auto heapAllocator = &m_heapAllocator;
+	m_deferredRelease.EnqueueForCurrentFrame([heapAllocator, resource, allocation]() mutable {
+		resource.Reset();
+		heapAllocator->Free(allocation);
+	});
+	resource.Reset();
+	allocation = HeapAllocation();
+}
+
 // ===============================================================================================
 void D3D12AppBase::CreateDepthBuffer(int width, int height)
 {
@@ -335,114 +418,96 @@ void D3D12AppBase::CreateDepthBuffer(int width, int height)
 			0 // MipSlice
 		}
 	};
-	CD3DX12_CPU_DESCRIPTOR_HANDLE dsvHandle(m_heapDsv->GetCPUDescriptorHandleForHeapStart());
-	m_device->CreateDepthStencilView(m_depthBuffer.Get(), &dsvDesc, dsvHandle);
+	m_dsvHandle = m_descriptorAllocators[D3D12_DESCRIPTOR_HEAP_TYPE_DSV].Allocate();
+	m_device->CreateDepthStencilView(m_depthBuffer.Get(), &dsvDesc, m_dsvHandle.cpu);
+	m_resourceStates.Register(m_depthBuffer.Get(), D3D12_RESOURCE_STATE_DEPTH_WRITE);
 }
 
-void D3D12AppBase::CreateCommandAllocators()
+void D3D12AppBase::CreateFrameFence()
 {
 	HRESULT hr;
-	m_commandAllocators.resize(FrameBufferCount);
-	for (UINT i = 0; i < FrameBufferCount; i++) {
-		hr = m_device->CreateCommandAllocator(
-			D3D12_COMMAND_LIST_TYPE_DIRECT,
-			IID_PPV_ARGS(&m_commandAllocators[i])
-		);
-		if (FAILED(hr))
-		{
-			throw std::runtime_error("Failed CreateCommandAllocator");
-		}
+	hr = m_device->CreateFence(
+		m_fenceValue, // Initialize value.
+		D3D12_FENCE_FLAG_NONE,
+		IID_PPV_ARGS(&m_frameFence)
+	);
+	if (FAILED(hr))
+	{
+		throw std::runtime_error("Failed CreateFence");
 	}
 }
 
-void D3D12AppBase::CreateFrameFences()
+UINT64 D3D12AppBase::SignalFence()
 {
-	HRESULT hr;
-	m_frameFences.resize(FrameBufferCount);
-	for (UINT i = 0; i < FrameBufferCount; i++) {
-		hr = m_device->CreateFence(
-			0, // Initialize value.
-			D3D12_FENCE_FLAG_NONE,
-			IID_PPV_ARGS(&m_frameFences[i])
-		);
-		if (FAILED(hr))
-		{
-			throw std::runtime_error("Failed CreateFence");
-		}
-	}
+	// Every submission gets the next value of the timeline.
+	const auto value = ++m_fenceValue;
+	m_commandQueue->Signal(m_frameFence.Get(), value);
+	return value;
 }
 
-void D3D12AppBase::WaitPreviousFrame()
+void D3D12AppBase::WaitForFenceValue(UINT64 value)
 {
-	// Set a value that set when GPU arrived to current fence.
-	auto& fence = m_frameFences[m_frameIndex];
-	const auto currentValue = ++m_frameFenceValues[m_frameIndex];
-	m_commandQueue->Signal(fence.Get(), currentValue);
-
-	// The next command or allocators are checked by a pair of fences 
-	// to make sure it has been executed.
-	auto nextIndex = (m_frameIndex + 1) % FrameBufferCount;
-	const auto finishExpected = m_frameFenceValues[nextIndex];
-	const auto nextFenceValue = m_frameFences[nextIndex]->GetCompletedValue();
-	if (nextFenceValue < finishExpected)
+	if (m_frameFence->GetCompletedValue() < value)
 	{
 		// Since GPU is in processing, wait in Event.
-		m_frameFences[nextIndex]->SetEventOnCompletion(finishExpected, m_fenceWaitEvent);
+		m_frameFence->SetEventOnCompletion(value, m_fenceWaitEvent);
 		WaitForSingleObject(m_fenceWaitEvent, GpuWaitTimeout);
 	}
 }
 
+void D3D12AppBase::WaitForGpu()
+{
+	WaitForFenceValue(SignalFence());
+}
+
+void D3D12AppBase::WaitPreviousFrame()
+{
+	// Mark the end of current frame on the timeline.
+	const auto fenceValue = m_framePacer.EndFrame();
+	m_uploadRing.FinishFrame(fenceValue);
+	m_descriptorRing.FinishFrame(fenceValue);
+	m_samplerRing.FinishFrame(fenceValue);
+	m_deferredRelease.FinishFrame(fenceValue);
+	m_commandListPool.Release(m_frameCommandList, fenceValue);
+	m_commandRecorder.Release(fenceValue);
+
+	m_framePacer.AdvanceFrame();
+}
+
 HRESULT D3D12AppBase::CompileShaderFromFile(
 	const std::wstring& fileName, const std::wstring& profile, ComPtr<ID3DBlob>& shaderBlob, ComPtr<ID3DBlob>& errorBlob
 ) 
 {
-	using namespace std::experimental::filesystem;
-
-	path filePath(fileName);
-	std::ifstream infile(filePath);
-	std::vector<char> srcData;
-	if (!infile)
-		throw std::runtime_error("shader not found");
-	srcData.resize(uint32_t(infile.seekg(0, infile.end).tellg()));
-	infile.seekg(0, infile.beg).read(srcData.data(), srcData.size());
-
-	// Compiling process by DXC (DirectX Shader Compiler). 
-	ComPtr<IDxcLibrary> library;
-	ComPtr<IDxcCompiler> compiler;
-	ComPtr<IDxcBlobEncoding> source;
-	ComPtr<IDxcOperationResult> dxcResult;
-
-	DxcCreateInstance(CLSID_DxcLibrary, IID_PPV_ARGS(&library));
-	library->CreateBlobWithEncodingFromPinned(srcData.data(), UINT(srcData.size()), CP_ACP, &source);
-	DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&compiler));
-
-	LPCWSTR compilerFlags[] = {
-#if _DEBUG
-		L"/Zi", L"/O0",
-#else
-		L"/O2" // Optimizing in Release Build. 
-#endif
-	};
-	compiler->Compile(source.Get(), filePath.wstring().c_str(),
-		L"main", profile.c_str(),
-		compilerFlags, _countof(compilerFlags),
-		nullptr, 0, // Defines. 
-		nullptr,
-		&dxcResult);
+	// Loaded from the shader cache when the source has not been changed.
+	return m_shaderCompiler.CompileFromFile(fileName, L"main", profile, {}, shaderBlob, errorBlob);
+}
 
-	HRESULT hr;
-	dxcResult->GetStatus(&hr);
-	if (SUCCEEDED(hr))
+HRESULT D3D12AppBase::CompileShaderFromFile(
+	const std::wstring& fileName, const std::wstring& entryPoint, const std::wstring& profile,
+	const std::vector<ShaderDefine>& defines, ComPtr<ID3DBlob>& shaderBlob, ComPtr<ID3DBlob>& errorBlob
+)
+{
+	return m_shaderCompiler.CompileFromFile(fileName, entryPoint, profile, defines, shaderBlob, errorBlob);
+}
+
+D3D12_SHADER_BYTECODE D3D12AppBase::LoadShader(const ShaderCompileJob& job, ComPtr<ID3DBlob>& shaderBlob)
+{
+	// Neither copied nor allocated, the bytecode and the blob point into the mapping of the archive.
+	D3D12_SHADER_BYTECODE bytecode = {};
+	ID3DBlob* archiveBlob;
+	if (m_shaderArchive.Find(job, bytecode, &archiveBlob))
 	{
-		dxcResult->GetResult(
-			reinterpret_cast<IDxcBlob**>(shaderBlob.GetAddressOf())
-		);
+		shaderBlob = archiveBlob;
+		return bytecode;
 	}
-	else
+
+	ComPtr<ID3DBlob> errorBlob;
+	HRESULT hr = CompileShaderFromFile(job.fileName, job.entryPoint, job.profile, job.defines, shaderBlob, errorBlob);
+	if (FAILED(hr))
 	{
-		dxcResult->GetErrorBuffer(
-			reinterpret_cast<IDxcBlobEncoding**>(errorBlob.GetAddressOf())
-		);
+		if (errorBlob)
+			OutputDebugStringA(static_cast<const char*>(errorBlob->GetBufferPointer()));
+		throw std::runtime_error("Failed CompileShaderFromFile");
 	}
-	return hr;
+	return CD3DX12_SHADER_BYTECODE(shaderBlob.Get());
 }
\ No newline at end of file
@@ -7,6 +7,24 @@
 
 #include "d3dx12.h"
 #include <wrl.h>
+#include "ResourceHeapAllocator.h"
+#include "DescriptorAllocator.h"
+#include "DescriptorRing.h"
+#include "UploadRingBuffer.h"
+#include "StaticBufferUploader.h"
+#include "TextureUploader.h"
+#include "DeferredReleaseQueue.h"
+#include "ShaderCompiler.h"
+#include "ShaderCompileService.h"
+#include "ShaderArchive.h"
+#include "ShaderReflector.h"
+#include "PipelineStateCache.h"
+#include "PipelineCompileQueue.h"
+#include "StatefulCommandList.h"
+#include "ResourceStateTracker.h"
+#include "CommandListPool.h"
+#include "FramePacer.h"
+#include "ParallelCommandRecorder.h"
 
 #pragma comment(lib, "d3d12.lib")
 #pragma comment(lib, "dxgi.lib")
@@ -22,33 +40,98 @@ public:
 
 	void Initialize(HWND hWnd);
 	void Terminate();
+	// Compile the shaders and write them to ShaderArchiveFile, which LoadShader() reads from the next start.
+	// Needs no device, so it can run as a build step instead of Initialize().
+	bool PackShaders(const std::vector<ShaderCompileJob>& jobs);
 
 	virtual void Render();
 	virtual void Setup() {}
 	virtual void Cleanup() {}
 	virtual void MakeCommand(ComPtr<ID3D12GraphicsCommandList>& command) {}
+	// Called on recording threads after MakeCommand() when SetRecordingJobCount() is not 0.
+	// Each job records its own list with render targets and heaps already set, and the lists
+	// are executed in job order after m_commandList. m_resourceStates must not be used here.
+	virtual void MakeCommandJob(UINT job, UINT jobCount, StatefulCommandList<>& command) {}
+
+	// The number of frames CPU can record ahead of GPU. Must be called before Initialize().
+	void SetFramesInFlight(UINT count);
+	UINT GetFramesInFlight() const { return m_framesInFlight; }
+	// Upload ring bytes a frame is expected to use. The ring holds it for every frame in flight
+	// and the recording one, and never gets smaller than UploadRingSize. Must be called before Initialize().
+	void SetUploadBytesPerFrame(UINT64 size);
 
 	const UINT GpuWaitTimeout = (10 * 1000);
 	const UINT FrameBufferCount = 2; 
+	const UINT MinFramesInFlight = 2;
+	const UINT MaxFramesInFlight = 4;
+	const UINT64 UploadRingSize = 16 * 1024 * 1024;
+	const UINT DescriptorRingSize = 16384;
+	const UINT SamplerRingSize = D3D12_MAX_SHADER_VISIBLE_SAMPLER_HEAP_SIZE;
+	const wchar_t* ShaderArchiveFile = L"Shaders.pak";
+#if defined(_DEBUG)
+	// Shaders edited since the packing are compiled instead of taken from the archive.
+	// It reads every source on each LoadShader(), release builds trust the archive.
+	const bool CheckShaderArchiveSources = true;
+#else
+	const bool CheckShaderArchiveSources = false;
+#endif
+	const wchar_t* PipelineCacheFile = L"PipelineCache.bin";
 
 protected:
 	virtual void PrepareDescriptorHeaps();
 	void PrepareRenderTargetView();
 	void CreateDepthBuffer(int width, int height);
-	void CreateCommandAllocators();
-	void CreateFrameFences();
+	void CreateFrameFence();
 	void WaitPreviousFrame();
+	UINT64 SignalFence();
+	void WaitForFenceValue(UINT64 value);
+	void WaitForGpu();
+	// The number of MakeCommandJob() calls per frame. 0 records the whole frame in MakeCommand().
+	void SetRecordingJobCount(UINT count) { m_recordingJobCount = count; }
+
+	// Release the object after GPU finished the current frame, or the given fence value.
+	template<class T>
+	void DeferRelease(ComPtr<T> object) { m_deferredRelease.EnqueueForCurrentFrame(std::move(object)); }
+	template<class T>
+	void DeferRelease(UINT64 fenceValue, T&& object) { m_deferredRelease.Enqueue(fenceValue, std::forward<T>(object)); }
 	HRESULT CompileShaderFromFile(
 		const std::wstring& filename, const std::wstring& profile, ComPtr<ID3DBlob>& shaderBlob, ComPtr<ID3DBlob>& errorBlob);
-
+	HRESULT CompileShaderFromFile(
+		const std::wstring& filename, const std::wstring& entryPoint, const std::wstring& profile,
+		const std::vector<ShaderDefine>& defines, ComPtr<ID3DBlob>& shaderBlob, ComPtr<ID3DBlob>& errorBlob);
+	// Shader from the archive when it has an entry, otherwise compiled from the file.
+	// The returned bytecode is shaderBlob's, which must be kept alive while it is used.
+	// A shader from the archive points into its mapping and is only valid while the archive is open,
+	// that is until PackShaders() or the destruction of the app.
+	D3D12_SHADER_BYTECODE LoadShader(const ShaderCompileJob& job, ComPtr<ID3DBlob>& shaderBlob);
+
+	// Persistent UPLOAD heap buffer. Use AllocateUpload() for data which lives only one frame.
 	ComPtr<ID3D12Resource> CreateBuffer(UINT bufferSize, const void* initialData);
+	bool AllocateUpload(UINT64 size, const void* initialData, UploadAllocation& allocation, UINT64 alignment = 256);
+	// DEFAULT heap buffer for static data. Pending uploads are copied together in FlushStaticUploads(),
+	// which is called after Setup(). The buffer is placed in the shared heaps, release it with ReleasePlacedResource().
+	ComPtr<ID3D12Resource1> CreateStaticBuffer(UINT64 bufferSize, const void* initialData, D3D12_RESOURCE_STATES state,
+		HeapAllocation& allocation);
+	void FlushStaticUploads();
+	// Resource placed in the shared heaps instead of its own implicit heap.
+	ComPtr<ID3D12Resource1> CreatePlacedResource(const D3D12_RESOURCE_DESC& desc, D3D12_HEAP_TYPE heapType,
+		D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue, HeapAllocation& allocation);
+	// Release the resource and its heap range after GPU finished the current frame.
+	void ReleasePlacedResource(ComPtr<ID3D12Resource1>& resource, HeapAllocation& allocation);
 
 	ComPtr<ID3D12Device> m_device;
+	// Declared before everything placing resources in it, to be destroyed last.
+	ResourceHeapAllocator m_heapAllocator;
 	ComPtr<ID3D12CommandQueue> m_commandQueue;
 	ComPtr<IDXGISwapChain4> m_swapChain;
 
-	ComPtr<ID3D12DescriptorHeap> m_heapRtv;
-	ComPtr<ID3D12DescriptorHeap> m_heapDsv;
+	// CPU only descriptors of each heap type.
+	DescriptorAllocator m_descriptorAllocators[D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES];
+	std::vector<DescriptorHandle> m_rtvHandles;
+	DescriptorHandle m_dsvHandle;
+	// Shader visible heaps. Bound once per frame before MakeCommand().
+	DescriptorRing m_descriptorRing;
+	DescriptorRing m_samplerRing;
 
 	std::vector<ComPtr<ID3D12Resource1>> m_renderTargets;
 	ComPtr<ID3D12Resource1> m_depthBuffer;
@@ -56,15 +139,60 @@ protected:
 	CD3DX12_VIEWPORT m_viewport;
 	CD3DX12_RECT m_scissorRect;
 
-	UINT m_rtvDescriptorSize;
 	UINT m_srvcbvDescriptorSize;
-	std::vector<ComPtr<ID3D12CommandAllocator>> m_commandAllocators;
 
+	// Timeline fence shared by every frame; values increase monotonically.
 	HANDLE m_fenceWaitEvent;
-	std::vector<ComPtr<ID3D12Fence1>> m_frameFences;
-	std::vector<UINT64> m_frameFenceValues;
-
+	ComPtr<ID3D12Fence1> m_frameFence;
+	UINT64 m_fenceValue;
+	// Paces the frames on m_frameFence. Its frame index selects the per frame data.
+	FramePacer m_framePacer;
+
+	// Declared before every user of it, to be destroyed last.
+	CommandListPool m_commandListPool;
+	// The list of the frame being recorded, acquired from m_commandListPool in Render().
+	PooledCommandList m_frameCommandList;
 	ComPtr<ID3D12GraphicsCommandList> m_commandList;
-
-	UINT m_frameIndex;
+	// Front end of m_commandList which drops redundant state changes. Use it in MakeCommand().
+	StatefulCommandList<> m_stateCommandList;
+	ParallelCommandRecorder m_commandRecorder;
+	UINT m_recordingJobCount = 0;
+
+	ShaderCompiler m_shaderCompiler;
+	// Compiles batches of shaders in parallel during Setup().
+	ShaderCompileService m_shaderCompileService;
+	// Shaders packed offline by PackShaders(). Opened in Initialize() when the file exists and matches the compiler.
+	ShaderArchive m_shaderArchive;
+	// Generates root signatures and input layouts from compiled shaders.
+	ShaderReflector m_shaderReflector;
+	// Shares root signatures and pipeline states, and keeps compiled pipelines on disk.
+	PipelineStateCache m_pipelineCache;
+	// Builds pipelines through m_pipelineCache on worker threads. Declared after the cache to be joined first.
+	PipelineCompileQueue m_pipelineCompileQueue;
+
+	// Transient upload memory reclaimed by frame fence value.
+	UploadRingBuffer m_uploadRing;
+	// States of the resources at the end of the recorded work. Barriers are generated from them.
+	ResourceStateTracker m_resourceStates;
+	StaticBufferUploader m_staticUploader;
+	TextureUploader m_textureUploader;
+	DeferredReleaseQueue m_deferredRelease;
+
+	UINT m_framesInFlight;
+	UINT64 m_uploadBytesPerFrame;
+	UINT m_backBufferIndex; // Index of swap chain back buffer.
+
+private:
+	// m_frameFence as seen by m_framePacer.
+	class QueueFence : public FrameFence {
+	public:
+		explicit QueueFence(D3D12AppBase* app) : m_app(app) {}
+		uint64_t Signal() override { return m_app->SignalFence(); }
+		uint64_t GetCompletedValue() const override { return m_app->m_frameFence->GetCompletedValue(); }
+		void Wait(uint64_t value) override { m_app->WaitForFenceValue(value); }
+
+	private:
+		D3D12AppBase* m_app;
+	};
+	QueueFence m_queueFence{ this };
 };
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <wrl.h>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+// Keeps objects alive until the fence value which must complete first has been reached.
+// Fence values are non-decreasing in the queue, so Drain() only touches the completed entries.
+class DeferredReleaseQueue {
+public:
+	template<class T>
+	using ComPtr = Microsoft::WRL::ComPtr<T>;
+	using ReleaseFunc = std::function<void()>;
+
+	~DeferredReleaseQueue() { ReleaseAll(); }
+
+	// Release after fenceValue completes.
+	void Enqueue(uint64_t fenceValue, ReleaseFunc release)
+	{
+		// Releasing later than requested is always safe, so keep the queue sorted.
+		if (!m_entries.empty() && fenceValue < m_entries.back().fenceValue)
+			fenceValue = m_entries.back().fenceValue;
+		m_entries.push_back({ fenceValue, std::move(release) });
+	}
+	template<class T>
+	void Enqueue(uint64_t fenceValue, ComPtr<T> object)
+	{
+		if (object)
+			Enqueue(fenceValue, [object]() mutable { object.Reset(); });
+	}
+
+	// Release after the fence value which will be given to FinishFrame() completes.
+	void EnqueueForCurrentFrame(ReleaseFunc release) { m_currentFrame.push_back(std::move(release)); }
+	template<class T>
+	void EnqueueForCurrentFrame(ComPtr<T> object)
+	{
+		if (object)
+			EnqueueForCurrentFrame([object]() mutable { object.Reset(); });
+	}
+
+	void FinishFrame(uint64_t fenceValue)
+	{
+		for (auto& release : m_currentFrame)
+			Enqueue(fenceValue, std::move(release));
+		m_currentFrame.clear();
+	}
+
+	void Drain(uint64_t completedValue)
+	{
+		while (!m_entries.empty() && m_entries.front().fenceValue <= completedValue)
+		{
+			m_entries.front().release();
+			m_entries.pop_front();
+		}
+	}
+
+	// Caller must make sure GPU is idle.
+	void ReleaseAll()
+	{
+		FinishFrame(0);
+		for (auto& entry : m_entries)
+			entry.release();
+		m_entries.clear();
+	}
+
+	size_t GetCount() const { return m_entries.size() + m_currentFrame.size(); }
+
+private:
+	struct Entry {
+		uint64_t fenceValue;
+		ReleaseFunc release;
+	};
+
+	std::deque<Entry> m_entries;
+	std::vector<ReleaseFunc> m_currentFrame;
+};
\ No newline at end of file
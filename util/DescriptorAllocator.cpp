@@ -0,0 +1,84 @@
+#include "DescriptorAllocator.h"
+#include <stdexcept>
+
+void DescriptorAllocator::Initialize(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type, UINT descriptorsPerPage)
+{
+	m_device = device;
+	m_type = type;
+	m_descriptorsPerPage = descriptorsPerPage;
+	m_descriptorSize = m_device->GetDescriptorHandleIncrementSize(type);
+}
+
+DescriptorHandle DescriptorAllocator::Allocate()
+{
+	// Drop the pages which have been filled since they were pushed.
+	while (!m_availablePages.empty() && m_pages[m_availablePages.back()].freeList.empty())
+	{
+		m_pages[m_availablePages.back()].available = false;
+		m_availablePages.pop_back();
+	}
+	if (m_availablePages.empty())
+	{
+		CreatePage();
+	}
+
+	const UINT pageIndex = m_availablePages.back();
+	auto& page = m_pages[pageIndex];
+	DescriptorHandle handle;
+	handle.page = pageIndex;
+	handle.index = page.freeList.back();
+	handle.cpu = CD3DX12_CPU_DESCRIPTOR_HANDLE(page.start, handle.index, m_descriptorSize);
+	page.freeList.pop_back();
+	m_allocated++;
+	return handle;
+}
+
+void DescriptorAllocator::Free(DescriptorHandle& handle)
+{
+	if (!handle.IsValid())
+		return;
+
+	auto& page = m_pages[handle.page];
+	page.freeList.push_back(handle.index);
+	if (!page.available)
+	{
+		page.available = true;
+		m_availablePages.push_back(handle.page);
+	}
+	m_allocated--;
+	handle = DescriptorHandle();
+}
+
+DescriptorAllocatorStats DescriptorAllocator::GetStats() const
+{
+	DescriptorAllocatorStats stats;
+	stats.pageCount = UINT(m_pages.size());
+	stats.capacity = stats.pageCount * m_descriptorsPerPage;
+	stats.allocated = m_allocated;
+	return stats;
+}
+
+void DescriptorAllocator::CreatePage()
+{
+	D3D12_DESCRIPTOR_HEAP_DESC heapDesc{
+		m_type,
+		m_descriptorsPerPage,
+		D3D12_DESCRIPTOR_HEAP_FLAG_NONE,
+		0
+	};
+	Page page;
+	HRESULT hr = m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&page.heap));
+	if (FAILED(hr))
+	{
+		throw std::runtime_error("Failed CreateDescriptorHeap(DescriptorAllocator)");
+	}
+	page.start = page.heap->GetCPUDescriptorHandleForHeapStart();
+	// Hand out lower indices first.
+	page.freeList.resize(m_descriptorsPerPage);
+	for (UINT i = 0; i < m_descriptorsPerPage; i++)
+		page.freeList[i] = m_descriptorsPerPage - 1 - i;
+	page.available = true;
+
+	m_pages.push_back(std::move(page));
+	m_availablePages.push_back(UINT(m_pages.size() - 1));
+}
\ No newline at end of file
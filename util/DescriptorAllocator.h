@@ -0,0 +1,61 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <d3d12.h>
+
+#include "d3dx12.h"
+#include <wrl.h>
+#include <vector>
+
+struct DescriptorHandle {
+	D3D12_CPU_DESCRIPTOR_HANDLE cpu{};
+	UINT page = UINT(-1);
+	UINT index = 0;
+
+	bool IsValid() const { return page != UINT(-1); }
+};
+
+struct DescriptorAllocatorStats {
+	UINT pageCount = 0;
+	UINT capacity = 0;
+	UINT allocated = 0;
+
+	float Occupancy() const { return capacity > 0 ? float(allocated) / float(capacity) : 0.0f; }
+};
+
+// CPU only (non shader visible) descriptor heap pages with a free list in each page.
+// Allocate and Free are O(1), and a new page is created when every page is full.
+// Views created here are copied to shader visible heaps with CopyDescriptors when they are bound.
+class DescriptorAllocator {
+public:
+	template<class T>
+	using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+	void Initialize(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type, UINT descriptorsPerPage = 256);
+
+	DescriptorHandle Allocate();
+	void Free(DescriptorHandle& handle);
+
+	D3D12_DESCRIPTOR_HEAP_TYPE GetType() const { return m_type; }
+	UINT GetDescriptorSize() const { return m_descriptorSize; }
+	DescriptorAllocatorStats GetStats() const;
+
+private:
+	struct Page {
+		ComPtr<ID3D12DescriptorHeap> heap;
+		D3D12_CPU_DESCRIPTOR_HANDLE start;
+		std::vector<UINT> freeList;
+		bool available; // Whether the page is in m_availablePages.
+	};
+
+	void CreatePage();
+
+	ComPtr<ID3D12Device> m_device;
+	D3D12_DESCRIPTOR_HEAP_TYPE m_type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+	UINT m_descriptorsPerPage = 0;
+	UINT m_descriptorSize = 0;
+	UINT m_allocated = 0;
+	std::vector<Page> m_pages;
+	std::vector<UINT> m_availablePages; // Pages which may have free descriptors.
+};
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include "DescriptorRing.h"
+#include <stdexcept>
+
+void DescriptorRing::Initialize(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type, UINT count)
+{
+	m_device = device;
+	m_type = type;
+
+	D3D12_DESCRIPTOR_HEAP_DESC heapDesc{
+		type,
+		count,
+		D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE,
+		0
+	};
+	HRESULT hr = m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_heap));
+	if (FAILED(hr))
+	{
+		throw std::runtime_error("Failed CreateDescriptorHeap(DescriptorRing)");
+	}
+	m_descriptorSize = m_device->GetDescriptorHandleIncrementSize(type);
+	m_cpuStart = m_heap->GetCPUDescriptorHandleForHeapStart();
+	m_gpuStart = m_heap->GetGPUDescriptorHandleForHeapStart();
+	m_ring.Reset(count);
+}
+
+bool DescriptorRing::Allocate(UINT count, DescriptorTable& table)
+{
+	UINT64 offset;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		offset = m_ring.Allocate(count);
+	}
+	if (offset == RingAllocator::InvalidOffset)
+		return false;
+
+	table.cpu = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_cpuStart, INT(offset), m_descriptorSize);
+	table.gpu = CD3DX12_GPU_DESCRIPTOR_HANDLE(m_gpuStart, INT(offset), m_descriptorSize);
+	table.count = count;
+	table.descriptorSize = m_descriptorSize;
+	return true;
+}
+
+bool DescriptorRing::AllocateTable(const D3D12_CPU_DESCRIPTOR_HANDLE* sources, UINT count, DescriptorTable& table)
+{
+	if (!Allocate(count, table))
+		return false;
+
+	// Sources can be scattered over pages, so copy one by one.
+	for (UINT i = 0; i < count; i++)
+	{
+		m_device->CopyDescriptorsSimple(1, table.Cpu(i), sources[i], m_type);
+	}
+	return true;
+}
\ No newline at end of file
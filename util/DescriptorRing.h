@@ -0,0 +1,52 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <d3d12.h>
+
+#include "d3dx12.h"
+#include <wrl.h>
+#include "RingAllocator.h"
+#include <mutex>
+
+// Contiguous range of the shader visible heap, bound by SetGraphicsRootDescriptorTable.
+struct DescriptorTable {
+	CD3DX12_CPU_DESCRIPTOR_HANDLE cpu;
+	CD3DX12_GPU_DESCRIPTOR_HANDLE gpu;
+	UINT count = 0;
+	UINT descriptorSize = 0;
+
+	CD3DX12_CPU_DESCRIPTOR_HANDLE Cpu(UINT index) const { return CD3DX12_CPU_DESCRIPTOR_HANDLE(cpu, index, descriptorSize); }
+};
+
+// Shader visible descriptor heap which is linearly allocated each frame.
+// Tables are filled from CPU only heaps and reclaimed by the fence value of the frame,
+// so one heap serves every draw and SetDescriptorHeaps is called once per frame.
+class DescriptorRing {
+public:
+	template<class T>
+	using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+	void Initialize(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type, UINT count);
+
+	// Return false when the ring is full. Tables may be allocated from recording threads.
+	bool Allocate(UINT count, DescriptorTable& table);
+	// Allocate a table and copy the descriptors of sources into it.
+	bool AllocateTable(const D3D12_CPU_DESCRIPTOR_HANDLE* sources, UINT count, DescriptorTable& table);
+
+	void FinishFrame(UINT64 fenceValue) { m_ring.FinishFrame(fenceValue); }
+	void Retire(UINT64 completedValue) { m_ring.Retire(completedValue); }
+
+	ID3D12DescriptorHeap* GetHeap() const { return m_heap.Get(); }
+	UINT GetUsedCount() const { return UINT(m_ring.GetUsedSize()); }
+
+private:
+	ComPtr<ID3D12Device> m_device;
+	ComPtr<ID3D12DescriptorHeap> m_heap;
+	D3D12_DESCRIPTOR_HEAP_TYPE m_type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+	UINT m_descriptorSize = 0;
+	D3D12_CPU_DESCRIPTOR_HANDLE m_cpuStart{};
+	D3D12_GPU_DESCRIPTOR_HANDLE m_gpuStart{};
+	RingAllocator m_ring; // In descriptor units.
+	std::mutex m_mutex;
+};
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Timeline fence of the queue executing the frames, seen by FramePacer.
+// Values returned by Signal() increase monotonically.
+class FrameFence {
+public:
+	virtual ~FrameFence() = default;
+
+	// Signal the next value after the work submitted so far and return it.
+	virtual uint64_t Signal() = 0;
+	virtual uint64_t GetCompletedValue() const = 0;
+	// Block until the value has completed. Values already completed return at once.
+	virtual void Wait(uint64_t value) = 0;
+};
+
+// Frame pacing on one timeline fence. The CPU records up to framesInFlight frames ahead of the GPU,
+// whatever the number of swap chain buffers, and per frame data is indexed by GetFrameIndex().
+// It has no dependency on D3D12, so it can be driven by a simulated fence.
+class FramePacer {
+public:
+	void Initialize(FrameFence* fence, uint32_t framesInFlight)
+	{
+		m_fence = fence;
+		m_frameIndex = 0;
+		m_frameFenceValues.assign(framesInFlight, 0);
+	}
+
+	// Mark the end of the frame recorded in the current slot and return its fence value.
+	uint64_t EndFrame()
+	{
+		m_frameFenceValues[m_frameIndex] = m_fence->Signal();
+		return m_frameFenceValues[m_frameIndex];
+	}
+
+	// Move to the next slot. The frame which used it was submitted framesInFlight frames ago,
+	// so the CPU only waits when the GPU falls that far behind.
+	void AdvanceFrame()
+	{
+		m_frameIndex = (m_frameIndex + 1) % uint32_t(m_frameFenceValues.size());
+		m_fence->Wait(m_frameFenceValues[m_frameIndex]);
+	}
+
+	uint32_t GetFrameIndex() const { return m_frameIndex; }
+	uint32_t GetFramesInFlight() const { return uint32_t(m_frameFenceValues.size()); }
+	uint64_t GetFrameFenceValue(uint32_t index) const { return m_frameFenceValues[index]; }
+
+private:
+	FrameFence* m_fence = nullptr;
+	uint32_t m_frameIndex = 0;
+	std::vector<uint64_t> m_frameFenceValues; // Fence value of each frame in flight.
+};
\ No newline at end of file
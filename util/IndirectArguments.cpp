@@ -0,0 +1,186 @@
+#include "IndirectArguments.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+	bool IsRootArgument(D3D12_INDIRECT_ARGUMENT_TYPE type)
+	{
+		return type == D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT ||
+			type == D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT_BUFFER_VIEW ||
+			type == D3D12_INDIRECT_ARGUMENT_TYPE_SHADER_RESOURCE_VIEW ||
+			type == D3D12_INDIRECT_ARGUMENT_TYPE_UNORDERED_ACCESS_VIEW;
+	}
+
+	bool IsWork(D3D12_INDIRECT_ARGUMENT_TYPE type)
+	{
+		return type == D3D12_INDIRECT_ARGUMENT_TYPE_DRAW ||
+			type == D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED ||
+			type == D3D12_INDIRECT_ARGUMENT_TYPE_DISPATCH;
+	}
+
+	UINT GetArgumentSize(const D3D12_INDIRECT_ARGUMENT_DESC& argument)
+	{
+		switch (argument.Type)
+		{
+		case D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT:
+			return argument.Constant.Num32BitValuesToSet * sizeof(UINT);
+		case D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT_BUFFER_VIEW:
+		case D3D12_INDIRECT_ARGUMENT_TYPE_SHADER_RESOURCE_VIEW:
+		case D3D12_INDIRECT_ARGUMENT_TYPE_UNORDERED_ACCESS_VIEW:
+			return sizeof(D3D12_GPU_VIRTUAL_ADDRESS);
+		case D3D12_INDIRECT_ARGUMENT_TYPE_VERTEX_BUFFER_VIEW:
+			return sizeof(D3D12_VERTEX_BUFFER_VIEW);
+		case D3D12_INDIRECT_ARGUMENT_TYPE_INDEX_BUFFER_VIEW:
+			return sizeof(D3D12_INDEX_BUFFER_VIEW);
+		case D3D12_INDIRECT_ARGUMENT_TYPE_DRAW:
+			return sizeof(D3D12_DRAW_ARGUMENTS);
+		case D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED:
+			return sizeof(D3D12_DRAW_INDEXED_ARGUMENTS);
+		case D3D12_INDIRECT_ARGUMENT_TYPE_DISPATCH:
+			return sizeof(D3D12_DISPATCH_ARGUMENTS);
+		default:
+			throw std::runtime_error("Unsupported indirect argument type.");
+		}
+	}
+}
+
+IndirectCommandLayout& IndirectCommandLayout::AddConstants(UINT rootParameterIndex, UINT num32BitValues, UINT destOffset)
+{
+	D3D12_INDIRECT_ARGUMENT_DESC argument{ D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT };
+	argument.Constant = { rootParameterIndex, destOffset, num32BitValues };
+	return Add(argument);
+}
+
+IndirectCommandLayout& IndirectCommandLayout::AddConstantBufferView(UINT rootParameterIndex)
+{
+	D3D12_INDIRECT_ARGUMENT_DESC argument{ D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT_BUFFER_VIEW };
+	argument.ConstantBufferView.RootParameterIndex = rootParameterIndex;
+	return Add(argument);
+}
+
+IndirectCommandLayout& IndirectCommandLayout::AddShaderResourceView(UINT rootParameterIndex)
+{
+	D3D12_INDIRECT_ARGUMENT_DESC argument{ D3D12_INDIRECT_ARGUMENT_TYPE_SHADER_RESOURCE_VIEW };
+	argument.ShaderResourceView.RootParameterIndex = rootParameterIndex;
+	return Add(argument);
+}
+
+IndirectCommandLayout& IndirectCommandLayout::AddUnorderedAccessView(UINT rootParameterIndex)
+{
+	D3D12_INDIRECT_ARGUMENT_DESC argument{ D3D12_INDIRECT_ARGUMENT_TYPE_UNORDERED_ACCESS_VIEW };
+	argument.UnorderedAccessView.RootParameterIndex = rootParameterIndex;
+	return Add(argument);
+}
+
+IndirectCommandLayout& IndirectCommandLayout::AddVertexBufferView(UINT slot)
+{
+	D3D12_INDIRECT_ARGUMENT_DESC argument{ D3D12_INDIRECT_ARGUMENT_TYPE_VERTEX_BUFFER_VIEW };
+	argument.VertexBuffer.Slot = slot;
+	return Add(argument);
+}
+
+IndirectCommandLayout& IndirectCommandLayout::AddIndexBufferView()
+{
+	return Add({ D3D12_INDIRECT_ARGUMENT_TYPE_INDEX_BUFFER_VIEW });
+}
+
+IndirectCommandLayout& IndirectCommandLayout::AddDraw()
+{
+	return Add({ D3D12_INDIRECT_ARGUMENT_TYPE_DRAW });
+}
+
+IndirectCommandLayout& IndirectCommandLayout::AddDrawIndexed()
+{
+	return Add({ D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED });
+}
+
+IndirectCommandLayout& IndirectCommandLayout::AddDispatch()
+{
+	return Add({ D3D12_INDIRECT_ARGUMENT_TYPE_DISPATCH });
+}
+
+UINT IndirectCommandLayout::GetSize(UINT argument) const
+{
+	return GetArgumentSize(m_arguments[argument]);
+}
+
+bool IndirectCommandLayout::HasRootArguments() const
+{
+	for (const auto& argument : m_arguments)
+	{
+		if (IsRootArgument(argument.Type))
+			return true;
+	}
+	return false;
+}
+
+bool IndirectCommandLayout::IsComplete() const
+{
+	return !m_arguments.empty() && IsWork(m_arguments.back().Type);
+}
+
+D3D12_COMMAND_SIGNATURE_DESC IndirectCommandLayout::GetDesc() const
+{
+	D3D12_COMMAND_SIGNATURE_DESC desc{};
+	desc.ByteStride = m_stride;
+	desc.NumArgumentDescs = UINT(m_arguments.size());
+	desc.pArgumentDescs = m_arguments.data();
+	return desc;
+}
+
+HRESULT IndirectCommandLayout::CreateCommandSignature(ID3D12Device* device, ID3D12RootSignature* rootSignature,
+	ComPtr<ID3D12CommandSignature>& commandSignature) const
+{
+	if (!IsComplete())
+		return E_INVALIDARG;
+	// The root signature must not be given when the command changes no root argument.
+	const auto desc = GetDesc();
+	return device->CreateCommandSignature(&desc, HasRootArguments() ? rootSignature : nullptr, IID_PPV_ARGS(&commandSignature));
+}
+
+IndirectCommandLayout& IndirectCommandLayout::Add(const D3D12_INDIRECT_ARGUMENT_DESC& argument)
+{
+	if (IsComplete())
+		throw std::runtime_error("Indirect arguments can't follow the draw or dispatch.");
+	m_arguments.push_back(argument);
+	m_offsets.push_back(m_stride);
+	m_stride += GetArgumentSize(argument);
+	return *this;
+}
+
+void IndirectArgumentBuffer::Reset(const IndirectCommandLayout& layout)
+{
+	m_layout = layout;
+	m_stride = layout.GetStride();
+	m_data.clear();
+}
+
+UINT IndirectArgumentBuffer::Append()
+{
+	const UINT command = GetCount();
+	m_data.resize(m_data.size() + m_stride, 0);
+	return command;
+}
+
+void IndirectArgumentBuffer::Write(UINT command, UINT argument, const void* data, UINT size)
+{
+	if (size > m_layout.GetSize(argument))
+		throw std::runtime_error("Indirect argument is larger than its layout.");
+	memcpy(GetCommand(command) + m_layout.GetOffset(argument), data, size);
+}
+
+UINT IndirectArgumentBuffer::Compact(const uint8_t* visible)
+{
+	const UINT count = GetCount();
+	UINT kept = 0;
+	for (UINT i = 0; i < count; i++)
+	{
+		if (!visible[i])
+			continue;
+		if (kept != i)
+			memcpy(GetCommand(kept), GetCommand(i), m_stride);
+		kept++;
+	}
+	m_data.resize(size_t(kept) * m_stride);
+	return kept;
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <d3d12.h>
+
+#include <wrl.h>
+#include <cstdint>
+#include <vector>
+
+// Layout of one command of an indirect argument buffer, from which the command signature is made.
+// Arguments are packed in the order they are added and the draw or dispatch must be the last one.
+class IndirectCommandLayout {
+public:
+	template<class T>
+	using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+	IndirectCommandLayout& AddConstants(UINT rootParameterIndex, UINT num32BitValues, UINT destOffset = 0);
+	IndirectCommandLayout& AddConstantBufferView(UINT rootParameterIndex);
+	IndirectCommandLayout& AddShaderResourceView(UINT rootParameterIndex);
+	IndirectCommandLayout& AddUnorderedAccessView(UINT rootParameterIndex);
+	IndirectCommandLayout& AddVertexBufferView(UINT slot);
+	IndirectCommandLayout& AddIndexBufferView();
+	IndirectCommandLayout& AddDraw();
+	IndirectCommandLayout& AddDrawIndexed();
+	IndirectCommandLayout& AddDispatch();
+
+	UINT GetArgumentCount() const { return UINT(m_arguments.size()); }
+	// Byte offset of an argument in a command.
+	UINT GetOffset(UINT argument) const { return m_offsets[argument]; }
+	UINT GetSize(UINT argument) const;
+	UINT GetStride() const { return m_stride; }
+	// Root arguments require the root signature when the command signature is created.
+	bool HasRootArguments() const;
+	bool IsComplete() const;
+
+	// The desc points into this layout.
+	D3D12_COMMAND_SIGNATURE_DESC GetDesc() const;
+	// rootSignature may be nullptr when the layout has no root arguments.
+	HRESULT CreateCommandSignature(ID3D12Device* device, ID3D12RootSignature* rootSignature,
+		ComPtr<ID3D12CommandSignature>& commandSignature) const;
+
+private:
+	IndirectCommandLayout& Add(const D3D12_INDIRECT_ARGUMENT_DESC& argument);
+
+	std::vector<D3D12_INDIRECT_ARGUMENT_DESC> m_arguments;
+	std::vector<UINT> m_offsets;
+	UINT m_stride = 0;
+};
+
+// Indirect commands packed on CPU in the layout of IndirectCommandLayout, then uploaded and
+// executed with one ExecuteIndirect. Compact() drops culled commands before the upload.
+// The layout is copied, so the buffer can be copied or moved independently of it.
+class IndirectArgumentBuffer {
+public:
+	// Resetting every frame with the same layout reuses the storage of the copy.
+	void Reset(const IndirectCommandLayout& layout);
+	void Clear() { m_data.clear(); }
+
+	// Append a zero filled command and return its index.
+	UINT Append();
+	// Write an argument of a command. size must not exceed the size of the argument.
+	void Write(UINT command, UINT argument, const void* data, UINT size);
+	template<class T>
+	void Write(UINT command, UINT argument, const T& data) { Write(command, argument, &data, sizeof(T)); }
+
+	// Remove the commands whose visible entry is 0, keeping the order of the others. Return the count left.
+	UINT Compact(const uint8_t* visible);
+
+	UINT GetCount() const { return m_stride > 0 ? UINT(m_data.size() / m_stride) : 0; }
+	UINT GetStride() const { return m_stride; }
+	// Bytes of the packed commands, to be copied to the GPU buffer given to ExecuteIndirect.
+	UINT64 GetSize() const { return m_data.size(); }
+	const UINT8* GetData() const { return m_data.data(); }
+	UINT8* GetCommand(UINT command) { return m_data.data() + size_t(command) * m_stride; }
+
+private:
+	IndirectCommandLayout m_layout;
+	UINT m_stride = 0;
+	std::vector<UINT8> m_data;
+};
\ No newline at end of file
@@ -0,0 +1,217 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <d3d12.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "IndirectArguments.h"
+#include "StatefulCommandList.h"
+#include "UploadRingBuffer.h"
+
+// Geometry drawn by InstanceBatcher. The vertex buffer is bound to slot 0.
+struct InstancedMesh {
+	D3D12_VERTEX_BUFFER_VIEW vertexBuffer;
+	D3D12_INDEX_BUFFER_VIEW indexBuffer;
+	UINT indexCount;
+};
+
+// Gathers the instances of a frame by mesh and material, so each pair is drawn with one DrawIndexedInstanced.
+// The per-instance data of every batch is written into one stream in the upload ring, which is bound once
+// and addressed by StartInstanceLocation. Instance is the layout of the INSTANCE_ inputs of the vertex shader.
+// Batches and their storage are kept between frames, so steady frames don't allocate.
+template<class Instance>
+class InstanceBatcher {
+public:
+	static const UINT InstanceSlot = 1;
+
+	// Root parameter of a 32 bit constant which receives the material of each draw. Draw() sets it
+	// per material, DrawIndirect() writes it into every command. Call before GetIndirectLayout().
+	void SetMaterialConstant(UINT rootParameterIndex)
+	{
+		m_materialParameter = int(rootParameterIndex);
+		m_indirectLayout = IndirectCommandLayout();
+	}
+
+	// Return the mesh id to use in Add().
+	UINT AddMesh(const InstancedMesh& mesh)
+	{
+		m_meshes.push_back(mesh);
+		return UINT(m_meshes.size() - 1);
+	}
+
+	void Clear()
+	{
+		for (auto& batch : m_batches)
+			batch.instances.clear();
+	}
+
+	void Add(UINT mesh, UINT material, const Instance& instance)
+	{
+		const uint64_t key = uint64_t(material) << 32 | mesh;
+		auto it = m_batchIndices.find(key);
+		if (it == m_batchIndices.end())
+		{
+			it = m_batchIndices.emplace(key, UINT(m_batches.size())).first;
+			m_batches.push_back({ key });
+			// Batches are drawn in key order, which groups the draws of a material.
+			m_order.push_back(it->second);
+			std::sort(m_order.begin(), m_order.end(), [this](UINT a, UINT b) { return m_batches[a].key < m_batches[b].key; });
+		}
+		m_batches[it->second].instances.push_back(instance);
+	}
+
+	// Write the instances of every batch into the ring. Return false when the ring is full.
+	bool Upload(UploadRingBuffer& ring)
+	{
+		UINT instanceCount = 0;
+		for (auto& batch : m_batches)
+		{
+			batch.startInstance = instanceCount;
+			instanceCount += UINT(batch.instances.size());
+		}
+		m_streamView = {};
+		if (instanceCount == 0)
+			return true;
+
+		UploadAllocation allocation;
+		const UINT64 size = UINT64(instanceCount) * sizeof(Instance);
+		if (!ring.Allocate(size, 16, allocation))
+			return false;
+		auto mapped = static_cast<UINT8*>(allocation.cpuAddress);
+		for (const auto& batch : m_batches)
+			memcpy(mapped + UINT64(batch.startInstance) * sizeof(Instance), batch.instances.data(), batch.instances.size() * sizeof(Instance));
+
+		m_streamView.BufferLocation = allocation.gpuAddress;
+		m_streamView.SizeInBytes = UINT(size);
+		m_streamView.StrideInBytes = sizeof(Instance);
+		return true;
+	}
+
+	// Draw every batch after Upload(). setMaterial(material) is called when the material changes,
+	// to set its root arguments. The pipeline and root signature must be set before.
+	template<class SetMaterial>
+	UINT Draw(StatefulCommandList<>& command, SetMaterial&& setMaterial) const
+	{
+		UINT draws = 0;
+		if (m_streamView.SizeInBytes == 0)
+			return draws;
+		bool first = true;
+		UINT material = 0;
+		command.IASetVertexBuffers(InstanceSlot, 1, &m_streamView);
+		for (const auto index : m_order)
+		{
+			const auto& batch = m_batches[index];
+			if (batch.instances.empty())
+				continue;
+			const UINT batchMaterial = UINT(batch.key >> 32);
+			if (first || batchMaterial != material)
+			{
+				setMaterial(batchMaterial);
+				if (m_materialParameter >= 0)
+					command.SetGraphicsRoot32BitConstants(UINT(m_materialParameter), 1, &batchMaterial, 0);
+				material = batchMaterial;
+				first = false;
+			}
+
+			const auto& mesh = m_meshes[UINT(batch.key)];
+			command.IASetVertexBuffers(0, 1, &mesh.vertexBuffer);
+			command.IASetIndexBuffer(&mesh.indexBuffer);
+			command.DrawIndexedInstanced(mesh.indexCount, UINT(batch.instances.size()), 0, 0, batch.startInstance);
+			draws++;
+		}
+		return draws;
+	}
+
+	// Layout of the commands of DrawIndirect(): the material constant when it is set,
+	// the mesh buffers and the instanced draw of a batch.
+	const IndirectCommandLayout& GetIndirectLayout()
+	{
+		if (m_indirectLayout.GetArgumentCount() == 0)
+		{
+			if (m_materialParameter >= 0)
+				m_indirectLayout.AddConstants(UINT(m_materialParameter), 1);
+			m_indirectLayout.AddVertexBufferView(0).AddIndexBufferView().AddDrawIndexed();
+		}
+		return m_indirectLayout;
+	}
+
+	// Same as Draw() with the batches of each material submitted by one ExecuteIndirect.
+	// signature must be created from GetIndirectLayout(). Return false when the ring is full.
+	template<class SetMaterial>
+	bool DrawIndirect(StatefulCommandList<>& command, UploadRingBuffer& ring, ID3D12CommandSignature* signature, SetMaterial&& setMaterial)
+	{
+		if (m_streamView.SizeInBytes == 0)
+			return true;
+		const auto& layout = GetIndirectLayout();
+		const UINT meshArgument = m_materialParameter >= 0 ? 1 : 0;
+
+		// Batches without instances are packed and then compacted away, as culled draws would be.
+		m_arguments.Reset(layout);
+		m_visible.clear();
+		m_commandMaterials.clear();
+		for (const auto index : m_order)
+		{
+			const auto& batch = m_batches[index];
+			const auto& mesh = m_meshes[UINT(batch.key)];
+			const UINT entry = m_arguments.Append();
+			D3D12_DRAW_INDEXED_ARGUMENTS draw{ mesh.indexCount, UINT(batch.instances.size()), 0, 0, batch.startInstance };
+			if (meshArgument > 0)
+				m_arguments.Write(entry, 0, UINT(batch.key >> 32));
+			m_arguments.Write(entry, meshArgument, mesh.vertexBuffer);
+			m_arguments.Write(entry, meshArgument + 1, mesh.indexBuffer);
+			m_arguments.Write(entry, meshArgument + 2, draw);
+			m_visible.push_back(batch.instances.empty() ? 0 : 1);
+			if (!batch.instances.empty())
+				m_commandMaterials.push_back(UINT(batch.key >> 32));
+		}
+		const UINT count = m_arguments.Compact(m_visible.data());
+
+		// Upload heap buffers are in GENERIC_READ, which includes INDIRECT_ARGUMENT.
+		UploadAllocation allocation;
+		if (count > 0 && !ring.Upload(m_arguments.GetData(), m_arguments.GetSize(), sizeof(UINT), allocation))
+			return false;
+
+		command.IASetVertexBuffers(InstanceSlot, 1, &m_streamView);
+		for (UINT begin = 0, end = 0; begin < count; begin = end)
+		{
+			const UINT material = m_commandMaterials[begin];
+			while (end < count && m_commandMaterials[end] == material)
+				end++;
+			setMaterial(material);
+			command.ExecuteIndirect(signature, end - begin, allocation.resource,
+				allocation.offset + UINT64(begin) * m_arguments.GetStride());
+		}
+		return true;
+	}
+
+	UINT GetInstanceCount() const
+	{
+		UINT count = 0;
+		for (const auto& batch : m_batches)
+			count += UINT(batch.instances.size());
+		return count;
+	}
+
+private:
+	struct Batch {
+		uint64_t key;	// Material in the upper half and mesh in the lower half.
+		std::vector<Instance> instances;
+		UINT startInstance = 0;
+	};
+
+	std::vector<InstancedMesh> m_meshes;
+	std::vector<Batch> m_batches;
+	std::vector<UINT> m_order;
+	std::unordered_map<uint64_t, UINT> m_batchIndices;
+	D3D12_VERTEX_BUFFER_VIEW m_streamView = {};
+
+	int m_materialParameter = -1;
+	IndirectCommandLayout m_indirectLayout;
+	IndirectArgumentBuffer m_arguments;
+	std::vector<uint8_t> m_visible;
+	std::vector<UINT> m_commandMaterials;	// Material of each command left after the compaction.
+};
\ No newline at end of file
@@ -0,0 +1,34 @@
+#include "ParallelCommandRecorder.h"
+#include <stdexcept>
+
+void ParallelCommandRecorder::Record(UINT jobCount, const RecordFunc& record)
+{
+	if (!m_lists.empty())
+		throw std::runtime_error("ParallelCommandRecorder lists must be released before the next Record().");
+	if (m_stateCommandLists.size() < jobCount)
+		m_stateCommandLists.resize(jobCount);
+	for (UINT i = 0; i < jobCount; i++)
+	{
+		m_lists.push_back(m_pool->Acquire(D3D12_COMMAND_LIST_TYPE_DIRECT));
+		m_stateCommandLists[i].Begin(m_lists[i].commandList.Get());
+	}
+	m_jobCount = jobCount;
+
+	m_runner.Run(jobCount, [this, &record](uint32_t job) { record(job, m_stateCommandLists[job]); });
+}
+
+void ParallelCommandRecorder::Close(std::vector<ID3D12CommandList*>& lists)
+{
+	for (auto& list : m_lists)
+	{
+		list->Close();
+		lists.push_back(list.commandList.Get());
+	}
+}
+
+void ParallelCommandRecorder::Release(UINT64 fenceValue)
+{
+	for (auto& list : m_lists)
+		m_pool->Release(list, fenceValue);
+	m_lists.clear();
+}
\ No newline at end of file
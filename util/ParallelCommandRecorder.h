@@ -0,0 +1,47 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <d3d12.h>
+
+#include <wrl.h>
+#include <functional>
+#include <vector>
+#include "CommandListPool.h"
+#include "ParallelJobRunner.h"
+#include "StatefulCommandList.h"
+
+// Records the jobs of a frame into their own command lists on worker threads.
+// The lists come from CommandListPool and go back to it with the fence value of the frame,
+// so an allocator is reset only after the frame using it has completed.
+// The recording thread runs jobs too, and Record() returns after every job has been recorded.
+class ParallelCommandRecorder {
+public:
+	template<class T>
+	using ComPtr = Microsoft::WRL::ComPtr<T>;
+	using RecordFunc = std::function<void(UINT job, StatefulCommandList<>& command)>;
+
+	// 0 means the number of hardware threads minus the render thread.
+	explicit ParallelCommandRecorder(UINT workerCount = 0) : m_runner(workerCount) {}
+
+	void Initialize(CommandListPool* pool) { m_pool = pool; }
+
+	// Acquire jobCount lists and record the jobs into them. The lists are left open.
+	// The first exception thrown by a job is rethrown after the others finished.
+	void Record(UINT jobCount, const RecordFunc& record);
+	// Close the lists of the last Record() and append them to lists in job order.
+	void Close(std::vector<ID3D12CommandList*>& lists);
+	// Return the lists to the pool after the submission which signaled fenceValue.
+	void Release(UINT64 fenceValue);
+
+	ID3D12GraphicsCommandList* GetCommandList(UINT job) const { return m_lists[job].commandList.Get(); }
+	UINT GetJobCount() const { return m_jobCount; }
+	UINT GetWorkerCount() const { return m_runner.GetWorkerCount(); }
+
+private:
+	CommandListPool* m_pool = nullptr;
+	std::vector<PooledCommandList> m_lists;
+	std::vector<StatefulCommandList<>> m_stateCommandLists;	// Grows to the largest job count.
+	UINT m_jobCount = 0;
+	ParallelJobRunner m_runner;
+};
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "ParallelJobRunner.h"
+#include <algorithm>
+
+ParallelJobRunner::ParallelJobRunner(uint32_t workerCount)
+{
+	const uint32_t threads = std::thread::hardware_concurrency();
+	m_workerCount = workerCount > 0 ? workerCount : std::max(1u, threads > 1 ? threads - 1 : 1u);
+}
+
+ParallelJobRunner::~ParallelJobRunner()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_exit = true;
+	}
+	m_condition.notify_all();
+	for (auto& worker : m_workers)
+		worker.join();
+}
+
+void ParallelJobRunner::Run(uint32_t jobCount, const JobFunc& func)
+{
+	if (jobCount == 0)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_workers.empty() && jobCount > 1)
+			Start();
+		m_func = &func;
+		m_jobCount = jobCount;
+		m_nextJob = 0;
+		m_exception = nullptr;
+		m_remaining = jobCount;
+		m_generation++;
+	}
+	m_condition.notify_all();
+
+	RunJobs();
+
+	std::exception_ptr exception;
+	{
+		// Workers which woke up late must leave RunJobs() before the next Run() rewrites the work.
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_doneCondition.wait(lock, [this]() { return m_remaining == 0 && m_active == 0; });
+		m_func = nullptr;
+		exception = m_exception;
+	}
+	if (exception)
+		std::rethrow_exception(exception);
+}
+
+void ParallelJobRunner::Start()
+{
+	for (uint32_t i = 0; i < m_workerCount; i++)
+		m_workers.emplace_back(&ParallelJobRunner::WorkerMain, this);
+}
+
+void ParallelJobRunner::WorkerMain()
+{
+	uint64_t generation = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this, generation]() { return m_exit || (m_generation != generation && m_func); });
+			if (m_exit)
+				return;
+			generation = m_generation;
+			m_active++;
+		}
+
+		RunJobs();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_active--;
+		}
+		m_doneCondition.notify_one();
+	}
+}
+
+void ParallelJobRunner::RunJobs()
+{
+	for (uint32_t job = m_nextJob++; job < m_jobCount; job = m_nextJob++)
+	{
+		try
+		{
+			(*m_func)(job);
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (!m_exception)
+				m_exception = std::current_exception();
+		}
+
+		bool done;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			done = --m_remaining == 0;
+		}
+		if (done)
+			m_doneCondition.notify_one();
+	}
+}
\ No newline at end of file
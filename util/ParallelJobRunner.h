@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs the jobs of one Run() call on a pool of worker threads and the calling thread.
+// Jobs are taken in index order from a shared counter, so a slow job doesn't hold back the others.
+// It has no dependency on D3D12, so the scheduling can be tested with any kind of job.
+class ParallelJobRunner {
+public:
+	using JobFunc = std::function<void(uint32_t job)>;
+
+	// 0 means the number of hardware threads minus the calling thread.
+	explicit ParallelJobRunner(uint32_t workerCount = 0);
+	~ParallelJobRunner();
+	ParallelJobRunner(const ParallelJobRunner&) = delete;
+	ParallelJobRunner& operator=(const ParallelJobRunner&) = delete;
+
+	// Run every job and return when all of them have finished. Workers are started by the first
+	// call with more than one job. The first exception thrown by a job is rethrown after the others finished.
+	void Run(uint32_t jobCount, const JobFunc& func);
+
+	uint32_t GetWorkerCount() const { return m_workerCount; }
+
+private:
+	void Start();
+	void WorkerMain();
+	void RunJobs();
+
+	// Work of the current Run(). Written by the calling thread while no worker is running jobs.
+	const JobFunc* m_func = nullptr;
+	uint32_t m_jobCount = 0;
+	std::atomic<uint32_t> m_nextJob{ 0 };
+	std::exception_ptr m_exception;
+
+	uint32_t m_workerCount;
+	std::vector<std::thread> m_workers;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::condition_variable m_doneCondition;
+	uint64_t m_generation = 0;	// Incremented by each Run() to wake the workers.
+	uint32_t m_remaining = 0;	// Jobs not finished yet.
+	uint32_t m_active = 0;		// Workers inside RunJobs().
+	bool m_exit = false;
+};
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include "PipelineCompileQueue.h"
+#include <algorithm>
+
+namespace {
+	void CopyBytecode(D3D12_SHADER_BYTECODE& bytecode, std::vector<char>& storage)
+	{
+		auto data = static_cast<const char*>(bytecode.pShaderBytecode);
+		storage.assign(data, data + bytecode.BytecodeLength);
+		bytecode.pShaderBytecode = storage.data();
+	}
+}
+
+PipelineCompileQueue::PipelineCompileQueue(UINT workerCount)
+{
+	const UINT threads = std::thread::hardware_concurrency();
+	m_workerCount = workerCount > 0 ? workerCount : std::max(1u, threads > 1 ? threads - 1 : 1u);
+}
+
+PipelineCompileQueue::~PipelineCompileQueue()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_exit = true;
+		// Pipelines not started yet are abandoned.
+		for (auto& request : m_requests)
+		{
+			request->state->result = E_ABORT;
+			request->state->status.store(PipelineHandle::Failed, std::memory_order_release);
+		}
+		m_requests.clear();
+	}
+	m_condition.notify_all();
+	m_idleCondition.notify_all();
+	for (auto& worker : m_workers)
+		worker.join();
+}
+
+PipelineHandle PipelineCompileQueue::Submit(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc)
+{
+	auto request = std::make_unique<Request>();
+	request->desc = desc;
+	request->desc.CachedPSO = {};
+	request->rootSignature = desc.pRootSignature;
+
+	D3D12_SHADER_BYTECODE* stages[] = {
+		&request->desc.VS, &request->desc.PS, &request->desc.DS, &request->desc.HS, &request->desc.GS };
+	for (size_t i = 0; i < _countof(stages); i++)
+		CopyBytecode(*stages[i], request->bytecodes[i]);
+
+	auto& inputLayout = request->desc.InputLayout;
+	request->inputElements.assign(inputLayout.pInputElementDescs, inputLayout.pInputElementDescs + inputLayout.NumElements);
+	for (auto& element : request->inputElements)
+	{
+		request->names.emplace_back(element.SemanticName);
+		element.SemanticName = request->names.back().c_str();
+	}
+	inputLayout.pInputElementDescs = request->inputElements.data();
+
+	auto& so = request->desc.StreamOutput;
+	request->soEntries.assign(so.pSODeclaration, so.pSODeclaration + so.NumEntries);
+	for (auto& entry : request->soEntries)
+	{
+		request->names.emplace_back(entry.SemanticName ? entry.SemanticName : "");
+		entry.SemanticName = request->names.back().c_str();
+	}
+	so.pSODeclaration = request->soEntries.data();
+	request->soStrides.assign(so.pBufferStrides, so.pBufferStrides + so.NumStrides);
+	so.pBufferStrides = request->soStrides.data();
+
+	PipelineHandle handle;
+	handle.m_state = std::make_shared<PipelineHandle::State>();
+	request->state = handle.m_state;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_workers.empty())
+			Start();
+		m_requests.push_back(std::move(request));
+	}
+	m_condition.notify_one();
+	return handle;
+}
+
+void PipelineCompileQueue::WaitIdle()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_idleCondition.wait(lock, [this]() { return m_requests.empty() && m_running == 0; });
+}
+
+UINT PipelineCompileQueue::GetPendingCount() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return UINT(m_requests.size()) + m_running;
+}
+
+void PipelineCompileQueue::Start()
+{
+	for (UINT i = 0; i < m_workerCount; i++)
+		m_workers.emplace_back(&PipelineCompileQueue::WorkerMain, this);
+}
+
+void PipelineCompileQueue::WorkerMain()
+{
+	for (;;)
+	{
+		std::unique_ptr<Request> request;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this]() { return m_exit || !m_requests.empty(); });
+			if (m_requests.empty())
+				return;
+			request = std::move(m_requests.front());
+			m_requests.pop_front();
+			m_running++;
+		}
+
+		auto& state = *request->state;
+		try
+		{
+			state.result = m_cache->CreateGraphicsPipelineState(request->desc, state.pipelineState);
+		}
+		catch (const std::exception&)
+		{
+			state.result = E_FAIL;
+		}
+		// The status is published last, after which the render thread may read the pipeline.
+		state.status.store(SUCCEEDED(state.result) ? PipelineHandle::Ready : PipelineHandle::Failed, std::memory_order_release);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_running--;
+		}
+		m_idleCondition.notify_all();
+	}
+}
\ No newline at end of file
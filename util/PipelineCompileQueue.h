@@ -0,0 +1,81 @@
+#pragma once
+
+#include "PipelineStateCache.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <thread>
+
+// Pipeline state compiled in background. Poll IsReady() from the render loop.
+class PipelineHandle {
+public:
+	enum Status { Pending, Ready, Failed };
+
+	PipelineHandle() = default;
+
+	bool IsValid() const { return m_state != nullptr; }
+	bool IsReady() const { return m_state && m_state->status.load(std::memory_order_acquire) == Ready; }
+	bool IsFailed() const { return m_state && m_state->status.load(std::memory_order_acquire) == Failed; }
+	HRESULT GetResult() const { return m_state ? m_state->result : E_FAIL; }
+
+	// The pipeline when ready, otherwise the fallback. nullptr means the draw should be skipped.
+	ID3D12PipelineState* Get(ID3D12PipelineState* fallback = nullptr) const
+	{
+		return IsReady() ? m_state->pipelineState.Get() : fallback;
+	}
+
+private:
+	friend class PipelineCompileQueue;
+
+	struct State {
+		std::atomic<int> status{ Pending };
+		HRESULT result = E_PENDING;
+		Microsoft::WRL::ComPtr<ID3D12PipelineState> pipelineState;
+	};
+	std::shared_ptr<State> m_state;
+};
+
+// Creates graphics pipeline states on worker threads through PipelineStateCache,
+// so the first frames are presented while pipelines are still compiling.
+class PipelineCompileQueue {
+public:
+	// 0 means the number of hardware threads minus the render thread.
+	explicit PipelineCompileQueue(UINT workerCount = 0);
+	~PipelineCompileQueue();
+
+	void Initialize(PipelineStateCache* cache) { m_cache = cache; }
+
+	// The desc is copied with everything it points to, so it may be released after the call.
+	PipelineHandle Submit(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc);
+	// Block until every submitted pipeline has finished.
+	void WaitIdle();
+
+	UINT GetPendingCount() const;
+
+private:
+	// Deep copy of a desc which keeps the pointed data alive on the worker.
+	struct Request {
+		D3D12_GRAPHICS_PIPELINE_STATE_DESC desc;
+		Microsoft::WRL::ComPtr<ID3D12RootSignature> rootSignature;
+		std::vector<char> bytecodes[5];
+		std::vector<D3D12_INPUT_ELEMENT_DESC> inputElements;
+		std::vector<D3D12_SO_DECLARATION_ENTRY> soEntries;
+		std::vector<UINT> soStrides;
+		std::deque<std::string> names;
+		std::shared_ptr<PipelineHandle::State> state;
+	};
+
+	void Start();
+	void WorkerMain();
+
+	PipelineStateCache* m_cache = nullptr;
+	UINT m_workerCount;
+	std::vector<std::thread> m_workers;
+	std::deque<std::unique_ptr<Request>> m_requests;
+	UINT m_running = 0;
+	mutable std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::condition_variable m_idleCondition;
+	bool m_exit = false;
+};
\ No newline at end of file
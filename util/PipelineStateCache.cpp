@@ -0,0 +1,179 @@
+#include "PipelineStateCache.h"
+#include <cwchar>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+	std::wstring GetPipelineName(uint64_t key)
+	{
+		wchar_t name[17];
+		swprintf_s(name, L"%016llx", static_cast<unsigned long long>(key));
+		return name;
+	}
+}
+
+void PipelineStateCache::Initialize(ID3D12Device* device, const std::wstring& fileName)
+{
+	m_device = device;
+	m_fileName = fileName;
+
+	// Pipeline libraries need ID3D12Device1. Without it the cache works only in memory.
+	ComPtr<ID3D12Device1> device1;
+	if (FAILED(m_device.As(&device1)))
+		return;
+
+	std::ifstream infile(fileName, std::ios::binary);
+	if (infile)
+	{
+		m_libraryData.resize(size_t(infile.seekg(0, infile.end).tellg()));
+		infile.seekg(0, infile.beg).read(m_libraryData.data(), m_libraryData.size());
+	}
+	HRESULT hr = E_FAIL;
+	if (!m_libraryData.empty())
+		hr = device1->CreatePipelineLibrary(m_libraryData.data(), m_libraryData.size(), IID_PPV_ARGS(&m_library));
+	if (FAILED(hr))
+	{
+		// A driver or adapter change invalidates the file. Start over with an empty library.
+		m_libraryData.clear();
+		hr = device1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&m_library));
+		if (FAILED(hr))
+			m_library.Reset();
+	}
+}
+
+bool PipelineStateCache::Save()
+{
+	std::lock_guard<std::mutex> lock(m_libraryMutex);
+	if (!m_library || !m_dirty)
+		return true;
+
+	std::vector<char> data(m_library->GetSerializedSize());
+	if (FAILED(m_library->Serialize(data.data(), data.size())))
+		return false;
+
+	std::ofstream outfile(m_fileName, std::ios::binary | std::ios::trunc);
+	outfile.write(data.data(), data.size());
+	if (!outfile)
+		return false;
+	m_dirty = false;
+	return true;
+}
+
+HRESULT PipelineStateCache::CreateRootSignature(ID3DBlob* serialized, ComPtr<ID3D12RootSignature>& rootSignature)
+{
+	const auto hash = PipelineStateKey::HashRootSignature(serialized->GetBufferPointer(), serialized->GetBufferSize());
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_rootSignatures.find(hash);
+		if (it != m_rootSignatures.end())
+		{
+			rootSignature = it->second;
+			return S_OK;
+		}
+	}
+
+	HRESULT hr = m_device->CreateRootSignature(
+		0, serialized->GetBufferPointer(), serialized->GetBufferSize(), IID_PPV_ARGS(&rootSignature));
+	if (FAILED(hr))
+		return hr;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto result = m_rootSignatures.emplace(hash, rootSignature);
+	rootSignature = result.first->second;
+	m_rootSignatureHashes[rootSignature.Get()] = hash;
+	return S_OK;
+}
+
+HRESULT PipelineStateCache::CreateGraphicsPipelineState(
+	const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, ComPtr<ID3D12PipelineState>& pipelineState)
+{
+	return GetOrCreate(GetKey(desc), [this, &desc](uint64_t key, ComPtr<ID3D12PipelineState>& created) {
+		return CreateFromLibrary(key, desc, created);
+	}, pipelineState);
+}
+
+void PipelineStateCache::RegisterRootSignature(ID3D12RootSignature* rootSignature, uint64_t hash)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_rootSignatureHashes[rootSignature] = hash;
+}
+
+uint64_t PipelineStateCache::GetKey(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc) const
+{
+	uint64_t rootSignatureHash = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_rootSignatureHashes.find(desc.pRootSignature);
+		if (it == m_rootSignatureHashes.end())
+			throw std::runtime_error("Root signature is not registered in the pipeline state cache.");
+		rootSignatureHash = it->second;
+	}
+	return PipelineStateKey::Hash(desc, rootSignatureHash);
+}
+
+HRESULT PipelineStateCache::GetOrCreate(uint64_t key, const CreateFunc& create, ComPtr<ID3D12PipelineState>& pipelineState)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_pipelineStates.find(key);
+		if (it != m_pipelineStates.end())
+		{
+			m_stats.hits++;
+			pipelineState = it->second;
+			return S_OK;
+		}
+	}
+
+	// Created outside of the lock, so that other pipelines can be compiled at the same time.
+	ComPtr<ID3D12PipelineState> created;
+	HRESULT hr = create(key, created);
+	if (FAILED(hr))
+		return hr;
+
+	// When another thread has created the same key meanwhile, its PSO is used.
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_stats.misses++;
+	pipelineState = m_pipelineStates.emplace(key, created).first->second;
+	return S_OK;
+}
+
+PipelineStateCacheStats PipelineStateCache::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+size_t PipelineStateCache::GetCount() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_pipelineStates.size();
+}
+
+HRESULT PipelineStateCache::CreateFromLibrary(
+	uint64_t key, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, ComPtr<ID3D12PipelineState>& pipelineState)
+{
+	const auto name = GetPipelineName(key);
+	if (m_library)
+	{
+		std::lock_guard<std::mutex> lock(m_libraryMutex);
+		if (SUCCEEDED(m_library->LoadGraphicsPipeline(name.c_str(), &desc, IID_PPV_ARGS(&pipelineState))))
+		{
+			std::lock_guard<std::mutex> statsLock(m_mutex);
+			m_stats.libraryHits++;
+			return S_OK;
+		}
+	}
+
+	HRESULT hr = m_device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&pipelineState));
+	if (FAILED(hr))
+		return hr;
+
+	if (m_library)
+	{
+		std::lock_guard<std::mutex> lock(m_libraryMutex);
+		// Fails with E_INVALIDARG when another thread has stored the same name, which is fine.
+		if (SUCCEEDED(m_library->StorePipeline(name.c_str(), pipelineState.Get())))
+			m_dirty = true;
+	}
+	return S_OK;
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <d3d12.h>
+
+#include <wrl.h>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "PipelineStateKey.h"
+
+struct PipelineStateCacheStats {
+	UINT hits = 0;			// Returned an existing PSO of this run.
+	UINT misses = 0;		// Created by the create function.
+	UINT libraryHits = 0;	// Misses loaded from the pipeline library without driver compilation.
+};
+
+// Pipeline states keyed by PipelineStateKey::Hash, so an equal desc returns the existing PSO.
+// Compiled pipelines are stored in an ID3D12PipelineLibrary which is saved to disk,
+// and later runs load them without driver compilation.
+class PipelineStateCache {
+public:
+	template<class T>
+	using ComPtr = Microsoft::WRL::ComPtr<T>;
+	using CreateFunc = std::function<HRESULT(uint64_t key, ComPtr<ID3D12PipelineState>& pipelineState)>;
+
+	PipelineStateCache() = default;
+	PipelineStateCache(const PipelineStateCache&) = delete;
+	PipelineStateCache& operator=(const PipelineStateCache&) = delete;
+
+	// The library is loaded from the file when it exists and matches the driver.
+	void Initialize(ID3D12Device* device, const std::wstring& fileName);
+	// Write the library when pipelines have been added. Returns false on failure.
+	bool Save();
+
+	// Root signatures made from the same serialized blob are shared.
+	HRESULT CreateRootSignature(ID3DBlob* serialized, ComPtr<ID3D12RootSignature>& rootSignature);
+	HRESULT CreateGraphicsPipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, ComPtr<ID3D12PipelineState>& pipelineState);
+
+	// The root signature must have been created by CreateRootSignature() or registered.
+	void RegisterRootSignature(ID3D12RootSignature* rootSignature, uint64_t hash);
+	uint64_t GetKey(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc) const;
+
+	// Return the PSO of the key, or call create once and keep the result. Doesn't use the device.
+	HRESULT GetOrCreate(uint64_t key, const CreateFunc& create, ComPtr<ID3D12PipelineState>& pipelineState);
+
+	PipelineStateCacheStats GetStats() const;
+	size_t GetCount() const;
+
+private:
+	HRESULT CreateFromLibrary(
+		uint64_t key, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, ComPtr<ID3D12PipelineState>& pipelineState);
+
+	ComPtr<ID3D12Device> m_device;
+	ComPtr<ID3D12PipelineLibrary> m_library;
+	// The library reads from this memory while it is alive.
+	std::vector<char> m_libraryData;
+	std::wstring m_fileName;
+	bool m_dirty = false;
+
+	mutable std::mutex m_mutex;
+	// Loads and stores of the same name must not run concurrently.
+	std::mutex m_libraryMutex;
+	std::unordered_map<uint64_t, ComPtr<ID3D12PipelineState>> m_pipelineStates;
+	std::unordered_map<uint64_t, ComPtr<ID3D12RootSignature>> m_rootSignatures;
+	std::unordered_map<ID3D12RootSignature*, uint64_t> m_rootSignatureHashes;
+	PipelineStateCacheStats m_stats;
+};
\ No newline at end of file
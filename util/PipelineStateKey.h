@@ -0,0 +1,120 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <d3d12.h>
+
+#include <cstdint>
+#include <cstring>
+#include "ShaderCache.h"
+
+// Stable hash of a pipeline state desc. Pointers are replaced by what they point to:
+// shaders by their bytecode, the root signature by the hash of its serialized blob,
+// and strings by their contents, so equal descs give the same key in every run.
+// Fields are added one by one since padding in the desc structs is not initialized.
+namespace PipelineStateKey {
+	inline void HashBytecode(ShaderHasher& hasher, const D3D12_SHADER_BYTECODE& bytecode)
+	{
+		hasher.Add(uint64_t(bytecode.BytecodeLength));
+		if (bytecode.BytecodeLength > 0)
+			hasher.Add(bytecode.pShaderBytecode, bytecode.BytecodeLength);
+	}
+
+	inline void HashString(ShaderHasher& hasher, const char* str)
+	{
+		const size_t length = str ? strlen(str) : 0;
+		hasher.Add(uint64_t(length));
+		hasher.Add(str, length);
+	}
+
+	inline void HashBlend(ShaderHasher& hasher, const D3D12_BLEND_DESC& blend)
+	{
+		hasher.Add(uint64_t(blend.AlphaToCoverageEnable)).Add(uint64_t(blend.IndependentBlendEnable));
+		for (const auto& rt : blend.RenderTarget)
+		{
+			const uint32_t values[] = {
+				uint32_t(rt.BlendEnable), uint32_t(rt.LogicOpEnable),
+				uint32_t(rt.SrcBlend), uint32_t(rt.DestBlend), uint32_t(rt.BlendOp),
+				uint32_t(rt.SrcBlendAlpha), uint32_t(rt.DestBlendAlpha), uint32_t(rt.BlendOpAlpha),
+				uint32_t(rt.LogicOp), uint32_t(rt.RenderTargetWriteMask) };
+			hasher.Add(values, sizeof(values));
+		}
+	}
+
+	inline void HashRasterizer(ShaderHasher& hasher, const D3D12_RASTERIZER_DESC& raster)
+	{
+		const uint32_t values[] = {
+			uint32_t(raster.FillMode), uint32_t(raster.CullMode), uint32_t(raster.FrontCounterClockwise),
+			uint32_t(raster.DepthBias), uint32_t(raster.DepthClipEnable), uint32_t(raster.MultisampleEnable),
+			uint32_t(raster.AntialiasedLineEnable), raster.ForcedSampleCount, uint32_t(raster.ConservativeRaster) };
+		const float floats[] = { raster.DepthBiasClamp, raster.SlopeScaledDepthBias };
+		hasher.Add(values, sizeof(values)).Add(floats, sizeof(floats));
+	}
+
+	inline void HashDepthStencil(ShaderHasher& hasher, const D3D12_DEPTH_STENCIL_DESC& depth)
+	{
+		const uint32_t values[] = {
+			uint32_t(depth.DepthEnable), uint32_t(depth.DepthWriteMask), uint32_t(depth.DepthFunc),
+			uint32_t(depth.StencilEnable), uint32_t(depth.StencilReadMask), uint32_t(depth.StencilWriteMask),
+			uint32_t(depth.FrontFace.StencilFailOp), uint32_t(depth.FrontFace.StencilDepthFailOp),
+			uint32_t(depth.FrontFace.StencilPassOp), uint32_t(depth.FrontFace.StencilFunc),
+			uint32_t(depth.BackFace.StencilFailOp), uint32_t(depth.BackFace.StencilDepthFailOp),
+			uint32_t(depth.BackFace.StencilPassOp), uint32_t(depth.BackFace.StencilFunc) };
+		hasher.Add(values, sizeof(values));
+	}
+
+	// Hash of a serialized root signature, which identifies the root signature created from it.
+	inline uint64_t HashRootSignature(const void* blob, size_t size)
+	{
+		return ShaderHasher().Add(blob, size).Get();
+	}
+
+	// CachedPSO is ignored since it doesn't change the resulting pipeline.
+	inline uint64_t Hash(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash)
+	{
+		ShaderHasher hasher;
+		hasher.Add(rootSignatureHash);
+		HashBytecode(hasher, desc.VS);
+		HashBytecode(hasher, desc.PS);
+		HashBytecode(hasher, desc.DS);
+		HashBytecode(hasher, desc.HS);
+		HashBytecode(hasher, desc.GS);
+
+		const auto& so = desc.StreamOutput;
+		hasher.Add(uint64_t(so.NumEntries)).Add(uint64_t(so.NumStrides)).Add(uint64_t(so.RasterizedStream));
+		for (UINT i = 0; i < so.NumEntries; i++)
+		{
+			const auto& entry = so.pSODeclaration[i];
+			HashString(hasher, entry.SemanticName);
+			const uint32_t values[] = {
+				entry.Stream, entry.SemanticIndex, entry.StartComponent, entry.ComponentCount, entry.OutputSlot };
+			hasher.Add(values, sizeof(values));
+		}
+		if (so.NumStrides > 0)
+			hasher.Add(so.pBufferStrides, sizeof(UINT) * so.NumStrides);
+
+		HashBlend(hasher, desc.BlendState);
+		hasher.Add(uint64_t(desc.SampleMask));
+		HashRasterizer(hasher, desc.RasterizerState);
+		HashDepthStencil(hasher, desc.DepthStencilState);
+
+		hasher.Add(uint64_t(desc.InputLayout.NumElements));
+		for (UINT i = 0; i < desc.InputLayout.NumElements; i++)
+		{
+			const auto& element = desc.InputLayout.pInputElementDescs[i];
+			HashString(hasher, element.SemanticName);
+			const uint32_t values[] = {
+				element.SemanticIndex, uint32_t(element.Format), element.InputSlot, element.AlignedByteOffset,
+				uint32_t(element.InputSlotClass), element.InstanceDataStepRate };
+			hasher.Add(values, sizeof(values));
+		}
+
+		const uint32_t values[] = {
+			uint32_t(desc.IBStripCutValue), uint32_t(desc.PrimitiveTopologyType), desc.NumRenderTargets,
+			uint32_t(desc.DSVFormat), desc.SampleDesc.Count, desc.SampleDesc.Quality, desc.NodeMask, uint32_t(desc.Flags) };
+		hasher.Add(values, sizeof(values));
+		for (UINT i = 0; i < desc.NumRenderTargets && i < 8; i++)
+			hasher.Add(uint64_t(desc.RTVFormats[i]));
+		return hasher.Get();
+	}
+}
\ No newline at end of file
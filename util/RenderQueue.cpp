@@ -0,0 +1,162 @@
+#include "RenderQueue.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace {
+	const uint32_t RadixBits = 8;
+	const uint32_t RadixSize = 1 << RadixBits;
+	const uint32_t RadixPasses = 64 / RadixBits;
+	// Below this, a thread spends more time waiting at the barriers than sorting.
+	const size_t MinPacketsPerThread = 16 * 1024;
+
+	inline uint32_t Digit(uint64_t key, uint32_t pass) { return uint32_t(key >> (pass * RadixBits)) & (RadixSize - 1); }
+
+	class Barrier {
+	public:
+		explicit Barrier(uint32_t count) : m_count(count) {}
+
+		void Wait()
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			const auto generation = m_generation;
+			if (++m_waiting == m_count)
+			{
+				m_waiting = 0;
+				m_generation++;
+				m_condition.notify_all();
+				return;
+			}
+			m_condition.wait(lock, [this, generation]() { return m_generation != generation; });
+		}
+
+	private:
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		uint32_t m_count;
+		uint32_t m_waiting = 0;
+		uint64_t m_generation = 0;
+	};
+}
+
+void RadixSort(RenderPacket* packets, RenderPacket* scratch, size_t count)
+{
+	if (count < 2)
+		return;
+
+	// The count of each digit doesn't depend on the order, so every pass is counted in one read.
+	std::vector<size_t> histograms(RadixPasses * RadixSize, 0);
+	for (size_t i = 0; i < count; i++)
+	{
+		for (uint32_t pass = 0; pass < RadixPasses; pass++)
+			histograms[pass * RadixSize + Digit(packets[i].key, pass)]++;
+	}
+
+	RenderPacket* src = packets;
+	RenderPacket* dst = scratch;
+	for (uint32_t pass = 0; pass < RadixPasses; pass++)
+	{
+		size_t* offsets = &histograms[pass * RadixSize];
+		if (offsets[Digit(src[0].key, pass)] == count)
+			continue;
+
+		size_t offset = 0;
+		for (uint32_t digit = 0; digit < RadixSize; digit++)
+		{
+			const size_t digitCount = offsets[digit];
+			offsets[digit] = offset;
+			offset += digitCount;
+		}
+		for (size_t i = 0; i < count; i++)
+			dst[offsets[Digit(src[i].key, pass)]++] = src[i];
+		std::swap(src, dst);
+	}
+
+	if (src != packets)
+		memcpy(packets, src, sizeof(RenderPacket) * count);
+}
+
+void ParallelRadixSort(RenderPacket* packets, RenderPacket* scratch, size_t count, uint32_t threadCount)
+{
+	threadCount = uint32_t(std::min<size_t>(threadCount, count / MinPacketsPerThread));
+	if (threadCount <= 1)
+	{
+		RadixSort(packets, scratch, count);
+		return;
+	}
+
+	// Digit counts of each thread's chunk for each pass. Chunks are contiguous and their outputs are
+	// placed in thread order within a digit, which keeps the sort stable.
+	std::vector<size_t> counts(size_t(threadCount) * RadixPasses * RadixSize, 0);
+	auto getCounts = [&](uint32_t thread, uint32_t pass) { return &counts[(size_t(thread) * RadixPasses + pass) * RadixSize]; };
+	Barrier barrier(threadCount);
+
+	auto sortChunk = [&](uint32_t thread) {
+		const size_t begin = count * thread / threadCount;
+		const size_t end = count * (thread + 1) / threadCount;
+		for (size_t i = begin; i < end; i++)
+		{
+			for (uint32_t pass = 0; pass < RadixPasses; pass++)
+				getCounts(thread, pass)[Digit(packets[i].key, pass)]++;
+		}
+		barrier.Wait();
+
+		// Every thread takes the same decision from the shared counts.
+		bool skip[RadixPasses];
+		for (uint32_t pass = 0; pass < RadixPasses; pass++)
+		{
+			const uint32_t digit = Digit(packets[0].key, pass);
+			size_t total = 0;
+			for (uint32_t t = 0; t < threadCount; t++)
+				total += getCounts(t, pass)[digit];
+			skip[pass] = total == count;
+		}
+
+		RenderPacket* src = packets;
+		RenderPacket* dst = scratch;
+		bool first = true;
+		for (uint32_t pass = 0; pass < RadixPasses; pass++)
+		{
+			if (skip[pass])
+				continue;
+
+			// The chunk has been reordered by the previous pass, so its counts are taken again.
+			if (!first)
+			{
+				size_t* local = getCounts(thread, pass);
+				std::fill(local, local + RadixSize, size_t(0));
+				for (size_t i = begin; i < end; i++)
+					local[Digit(src[i].key, pass)]++;
+				barrier.Wait();
+			}
+			first = false;
+
+			size_t offsets[RadixSize];
+			size_t offset = 0;
+			for (uint32_t digit = 0; digit < RadixSize; digit++)
+			{
+				for (uint32_t t = 0; t < threadCount; t++)
+				{
+					if (t == thread)
+						offsets[digit] = offset;
+					offset += getCounts(t, pass)[digit];
+				}
+			}
+			for (size_t i = begin; i < end; i++)
+				dst[offsets[Digit(src[i].key, pass)]++] = src[i];
+			barrier.Wait();
+			std::swap(src, dst);
+		}
+
+		if (src != packets)
+			memcpy(packets + begin, src + begin, sizeof(RenderPacket) * (end - begin));
+	};
+
+	std::vector<std::thread> threads;
+	for (uint32_t thread = 1; thread < threadCount; thread++)
+		threads.emplace_back(sortChunk, thread);
+	sortChunk(0);
+	for (auto& thread : threads)
+		thread.join();
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Draw reference sorted by its key. draw indexes the draw data of the queue.
+struct RenderPacket {
+	uint64_t key;
+	uint32_t draw;
+};
+
+// Stable LSD radix sort of packets by key, 8 bits per pass. scratch must hold count packets.
+// Passes where every key has the same digit are skipped, so keys using few bits sort in few passes.
+void RadixSort(RenderPacket* packets, RenderPacket* scratch, size_t count);
+// Same result as RadixSort(), each pass split over threadCount threads including the calling one.
+// Small counts are sorted on the calling thread.
+void ParallelRadixSort(RenderPacket* packets, RenderPacket* scratch, size_t count, uint32_t threadCount);
+
+// Sort keys of draws. Bits from the most significant:
+//   opaque:      pass 8 | pipeline 12 | material 20 | depth 24  (front to back within a material)
+//   transparent: pass 8 | ~depth 24 | pipeline 12 | material 20  (back to front over everything)
+// Opaque draws are grouped by state first to minimize state changes, while transparent draws
+// must keep the depth order for blending. Ids wider than their field are masked.
+namespace RenderSortKey {
+	const uint32_t PassBits = 8;
+	const uint32_t PipelineBits = 12;
+	const uint32_t MaterialBits = 20;
+	const uint32_t DepthBits = 24;
+
+	inline uint64_t Field(uint32_t value, uint32_t bits) { return uint64_t(value) & ((1ull << bits) - 1); }
+
+	// Depth quantized keeping its order. Positive floats compare the same as their bit patterns,
+	// so the top bits keep the order over any range; negative depth is clamped to 0.
+	inline uint32_t QuantizeDepth(float viewDepth)
+	{
+		if (!(viewDepth > 0.0f))
+			return 0;
+		uint32_t bits;
+		memcpy(&bits, &viewDepth, sizeof(bits));
+		return bits >> (32 - DepthBits);
+	}
+
+	inline uint64_t MakeOpaque(uint32_t pass, uint32_t pipeline, uint32_t material, float viewDepth)
+	{
+		return Field(pass, PassBits) << (64 - PassBits) |
+			Field(pipeline, PipelineBits) << (MaterialBits + DepthBits) |
+			Field(material, MaterialBits) << DepthBits |
+			QuantizeDepth(viewDepth);
+	}
+
+	inline uint64_t MakeTransparent(uint32_t pass, uint32_t pipeline, uint32_t material, float viewDepth)
+	{
+		const uint32_t invertedDepth = ~QuantizeDepth(viewDepth) & ((1u << DepthBits) - 1);
+		return Field(pass, PassBits) << (64 - PassBits) |
+			uint64_t(invertedDepth) << (PipelineBits + MaterialBits) |
+			Field(pipeline, PipelineBits) << MaterialBits |
+			Field(material, MaterialBits);
+	}
+
+	inline uint32_t GetPass(uint64_t key) { return uint32_t(key >> (64 - PassBits)); }
+	// Material of a key made by MakeOpaque().
+	inline uint32_t GetOpaqueMaterial(uint64_t key) { return uint32_t(Field(uint32_t(key >> DepthBits), MaterialBits)); }
+}
+
+// Draws collected during a frame and submitted in the order of their sort keys.
+// Draw is the data to record a draw, kept in push order while only the packets move in the sort.
+template<class Draw>
+class RenderQueue {
+public:
+	void Clear()
+	{
+		m_packets.clear();
+		m_draws.clear();
+	}
+
+	void Reserve(size_t count)
+	{
+		m_packets.reserve(count);
+		m_draws.reserve(count);
+	}
+
+	void Push(uint64_t key, const Draw& draw)
+	{
+		m_packets.push_back({ key, uint32_t(m_draws.size()) });
+		m_draws.push_back(draw);
+	}
+
+	// threadCount greater than 1 sorts large queues in parallel.
+	void Sort(uint32_t threadCount = 1)
+	{
+		m_scratch.resize(m_packets.size());
+		if (threadCount > 1)
+			ParallelRadixSort(m_packets.data(), m_scratch.data(), m_packets.size(), threadCount);
+		else
+			RadixSort(m_packets.data(), m_scratch.data(), m_packets.size());
+	}
+
+	// Call func(key, draw) for every draw in the sorted order.
+	template<class Func>
+	void Submit(Func&& func) const
+	{
+		for (const auto& packet : m_packets)
+			func(packet.key, m_draws[packet.draw]);
+	}
+
+	size_t GetCount() const { return m_packets.size(); }
+	const std::vector<RenderPacket>& GetPackets() const { return m_packets; }
+	const Draw& GetDraw(const RenderPacket& packet) const { return m_draws[packet.draw]; }
+
+private:
+	std::vector<RenderPacket> m_packets;
+	std::vector<RenderPacket> m_scratch;
+	std::vector<Draw> m_draws;
+};
\ No newline at end of file
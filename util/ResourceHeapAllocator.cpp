@@ -0,0 +1,138 @@
+#include "ResourceHeapAllocator.h"
+#include <algorithm>
+#include <stdexcept>
+
+void ResourceHeapAllocator::Initialize(ID3D12Device* device, UINT64 heapSize)
+{
+	m_device = device;
+	m_heapSize = heapSize;
+}
+
+ResourceHeapAllocator::ComPtr<ID3D12Resource1> ResourceHeapAllocator::CreateResource(
+	const D3D12_RESOURCE_DESC& desc, D3D12_HEAP_TYPE heapType, D3D12_RESOURCE_STATES initialState,
+	const D3D12_CLEAR_VALUE* clearValue, HeapAllocation& allocation)
+{
+	const auto info = m_device->GetResourceAllocationInfo(0, 1, &desc);
+	if (info.SizeInBytes == UINT64_MAX)
+	{
+		throw std::runtime_error("Failed GetResourceAllocationInfo");
+	}
+
+	const auto poolIndex = FindPool(heapType, CategoryOf(desc));
+	auto& pool = m_pools[poolIndex];
+
+	// First fit over the heaps of the pool, then a new heap.
+	UINT heapIndex = 0;
+	UINT64 offset = BuddyAllocator::InvalidOffset;
+	for (; heapIndex < pool.heaps.size(); heapIndex++)
+	{
+		offset = pool.heaps[heapIndex]->allocator.Allocate(info.SizeInBytes, info.Alignment);
+		if (offset != BuddyAllocator::InvalidOffset)
+			break;
+	}
+	if (offset == BuddyAllocator::InvalidOffset)
+	{
+		// A resource larger than the heap size gets a heap of its own.
+		UINT64 size = m_heapSize;
+		while (size < info.SizeInBytes)
+			size *= 2;
+		auto heap = CreateHeap(pool, size);
+		heapIndex = UINT(pool.heaps.size() - 1);
+		offset = heap->allocator.Allocate(info.SizeInBytes, info.Alignment);
+	}
+
+	ComPtr<ID3D12Resource1> resource;
+	HRESULT hr = m_device->CreatePlacedResource(
+		pool.heaps[heapIndex]->heap.Get(),
+		offset,
+		&desc,
+		initialState,
+		clearValue,
+		IID_PPV_ARGS(&resource)
+	);
+	if (FAILED(hr))
+	{
+		pool.heaps[heapIndex]->allocator.Free(offset);
+		throw std::runtime_error("Failed CreatePlacedResource");
+	}
+
+	allocation.poolIndex = poolIndex;
+	allocation.heapIndex = heapIndex;
+	allocation.offset = offset;
+	return resource;
+}
+
+void ResourceHeapAllocator::Free(HeapAllocation& allocation)
+{
+	if (!allocation.IsValid())
+		return;
+	m_pools[allocation.poolIndex].heaps[allocation.heapIndex]->allocator.Free(allocation.offset);
+	allocation = HeapAllocation();
+}
+
+ResourceHeapStats ResourceHeapAllocator::GetStats()
+{
+	ResourceHeapStats stats;
+	for (auto& pool : m_pools)
+	{
+		for (auto& heap : pool.heaps)
+		{
+			const auto& heapStats = heap->allocator.GetStats();
+			stats.heapCount++;
+			stats.heapBytes += heapStats.size;
+			stats.requestedBytes += heapStats.requestedBytes;
+			stats.allocatedBytes += heapStats.allocatedBytes;
+			stats.allocationCount += heapStats.allocationCount;
+			stats.fragmentation = std::max(stats.fragmentation, heapStats.Fragmentation());
+		}
+	}
+	return stats;
+}
+
+ResourceHeapAllocator::Category ResourceHeapAllocator::CategoryOf(const D3D12_RESOURCE_DESC& desc)
+{
+	if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+		return CategoryBuffer;
+	if (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL))
+		return CategoryRenderTarget;
+	return CategoryTexture;
+}
+
+UINT ResourceHeapAllocator::FindPool(D3D12_HEAP_TYPE heapType, Category category)
+{
+	for (UINT i = 0; i < m_pools.size(); i++)
+	{
+		if (m_pools[i].heapType == heapType && m_pools[i].category == category)
+			return i;
+	}
+	m_pools.push_back({ heapType, category });
+	return UINT(m_pools.size() - 1);
+}
+
+ResourceHeapAllocator::Heap* ResourceHeapAllocator::CreateHeap(Pool& pool, UINT64 size)
+{
+	const D3D12_HEAP_FLAGS categoryFlags[CategoryCount] = {
+		D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS,
+		D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES,
+		D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES,
+	};
+
+	// 4MB alignment makes MSAA textures placeable too.
+	CD3DX12_HEAP_DESC heapDesc(
+		size,
+		pool.heapType,
+		D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT,
+		categoryFlags[pool.category]
+	);
+
+	auto heap = std::make_unique<Heap>();
+	HRESULT hr = m_device->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap->heap));
+	if (FAILED(hr))
+	{
+		throw std::runtime_error("Failed CreateHeap");
+	}
+	heap->allocator.Reset(size, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+
+	pool.heaps.push_back(std::move(heap));
+	return pool.heaps.back().get();
+}
\ No newline at end of file
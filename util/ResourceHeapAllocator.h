@@ -0,0 +1,73 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <d3d12.h>
+
+#include "d3dx12.h"
+#include <wrl.h>
+#include <memory>
+#include <vector>
+#include "BuddyAllocator.h"
+
+// Location of a placed resource in the heaps of ResourceHeapAllocator.
+struct HeapAllocation {
+	UINT poolIndex = UINT(-1);
+	UINT heapIndex = 0;
+	UINT64 offset = 0;
+
+	bool IsValid() const { return poolIndex != UINT(-1); }
+};
+
+struct ResourceHeapStats {
+	UINT heapCount = 0;
+	UINT64 heapBytes = 0;
+	UINT64 requestedBytes = 0;	// Sum of GetResourceAllocationInfo sizes.
+	UINT64 allocatedBytes = 0;	// Sum of buddy blocks.
+	UINT64 allocationCount = 0;
+	double fragmentation = 0.0; // Worst fragmentation of the heaps.
+};
+
+// Creates large ID3D12Heap blocks and places buffers and textures inside them with a buddy allocator.
+// Resources are grouped into buffers, textures and render target / depth textures so that it works
+// on resource heap tier 1.
+class ResourceHeapAllocator {
+public:
+	template<class T>
+	using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+	void Initialize(ID3D12Device* device, UINT64 heapSize = 64 * 1024 * 1024);
+
+	ComPtr<ID3D12Resource1> CreateResource(
+		const D3D12_RESOURCE_DESC& desc, D3D12_HEAP_TYPE heapType, D3D12_RESOURCE_STATES initialState,
+		const D3D12_CLEAR_VALUE* clearValue, HeapAllocation& allocation);
+	// The resource placed at the allocation must be released and unused by GPU.
+	void Free(HeapAllocation& allocation);
+
+	ResourceHeapStats GetStats();
+
+private:
+	enum Category {
+		CategoryBuffer,
+		CategoryTexture,
+		CategoryRenderTarget,
+		CategoryCount
+	};
+	struct Heap {
+		ComPtr<ID3D12Heap> heap;
+		BuddyAllocator allocator;
+	};
+	struct Pool {
+		D3D12_HEAP_TYPE heapType;
+		Category category;
+		std::vector<std::unique_ptr<Heap>> heaps;
+	};
+
+	static Category CategoryOf(const D3D12_RESOURCE_DESC& desc);
+	UINT FindPool(D3D12_HEAP_TYPE heapType, Category category);
+	Heap* CreateHeap(Pool& pool, UINT64 size);
+
+	ComPtr<ID3D12Device> m_device;
+	UINT64 m_heapSize = 0;
+	std::vector<Pool> m_pools;
+};
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "ResourceStateTracker.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+	UINT CountSubresources(ID3D12Resource* resource)
+	{
+		const auto desc = resource->GetDesc();
+		if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+			return 1;
+		// Planar formats are not handled; their planes are tracked as one.
+		const UINT arraySize = desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? 1 : desc.DepthOrArraySize;
+		return std::max<UINT>(1, desc.MipLevels) * arraySize;
+	}
+}
+
+void ResourceStateTracker::Register(ID3D12Resource* resource, D3D12_RESOURCE_STATES state)
+{
+	m_resources[resource] = { state, {}, CountSubresources(resource) };
+	m_splits.erase(resource);
+}
+
+void ResourceStateTracker::Unregister(ID3D12Resource* resource)
+{
+	m_resources.erase(resource);
+	m_splits.erase(resource);
+	m_pending.erase(std::remove_if(m_pending.begin(), m_pending.end(), [resource](const D3D12_RESOURCE_BARRIER& barrier) {
+		return barrier.Type == D3D12_RESOURCE_BARRIER_TYPE_TRANSITION ? barrier.Transition.pResource == resource : barrier.UAV.pResource == resource;
+	}), m_pending.end());
+}
+
+D3D12_RESOURCE_STATES ResourceStateTracker::GetState(ID3D12Resource* resource, UINT subresource) const
+{
+	auto it = m_resources.find(resource);
+	if (it == m_resources.end())
+		throw std::runtime_error("Resource is not registered in the state tracker.");
+	const auto& tracked = it->second;
+	return tracked.subresources.empty() ? tracked.state : tracked.subresources[subresource];
+}
+
+UINT ResourceStateTracker::GetSubresourceCount(ID3D12Resource* resource) const
+{
+	auto it = m_resources.find(resource);
+	return it != m_resources.end() ? it->second.subresourceCount : 0;
+}
+
+void ResourceStateTracker::Transition(ID3D12Resource* resource, D3D12_RESOURCE_STATES after, UINT subresource)
+{
+	// A split transition still in flight is ended first.
+	if (m_splits.count(resource))
+		EndTransition(resource);
+	AddTransitions(resource, after, subresource, D3D12_RESOURCE_BARRIER_FLAG_NONE, nullptr);
+}
+
+void ResourceStateTracker::BeginTransition(ID3D12Resource* resource, D3D12_RESOURCE_STATES after, UINT subresource)
+{
+	if (m_splits.count(resource))
+		EndTransition(resource);
+	std::vector<D3D12_RESOURCE_BARRIER> begun;
+	AddTransitions(resource, after, subresource, D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY, &begun);
+	if (!begun.empty())
+		m_splits[resource] = std::move(begun);
+}
+
+void ResourceStateTracker::EndTransition(ID3D12Resource* resource)
+{
+	auto it = m_splits.find(resource);
+	if (it == m_splits.end())
+		return;
+	for (auto barrier : it->second)
+	{
+		barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
+		m_pending.push_back(barrier);
+	}
+	m_splits.erase(it);
+}
+
+void ResourceStateTracker::UAVBarrier(ID3D12Resource* resource)
+{
+	m_pending.push_back(CD3DX12_RESOURCE_BARRIER::UAV(resource));
+}
+
+UINT ResourceStateTracker::Flush(ID3D12GraphicsCommandList* commandList)
+{
+	const UINT count = UINT(m_pending.size());
+	if (count > 0)
+		commandList->ResourceBarrier(count, m_pending.data());
+	m_pending.clear();
+	return count;
+}
+
+UINT ResourceStateTracker::Flush(ID3D12GraphicsCommandList* commandList, ID3D12Resource* const* resources, UINT resourceCount)
+{
+	// Barriers of the resources are moved to the front, both parts keeping their order.
+	const auto end = std::stable_partition(m_pending.begin(), m_pending.end(), [=](const D3D12_RESOURCE_BARRIER& barrier) {
+		const auto resource = barrier.Type == D3D12_RESOURCE_BARRIER_TYPE_TRANSITION ? barrier.Transition.pResource : barrier.UAV.pResource;
+		return std::find(resources, resources + resourceCount, resource) != resources + resourceCount;
+	});
+	const UINT count = UINT(end - m_pending.begin());
+	if (count > 0)
+		commandList->ResourceBarrier(count, m_pending.data());
+	m_pending.erase(m_pending.begin(), end);
+	return count;
+}
+
+void ResourceStateTracker::AddTransitions(ID3D12Resource* resource, D3D12_RESOURCE_STATES after, UINT subresource,
+	D3D12_RESOURCE_BARRIER_FLAGS flags, std::vector<D3D12_RESOURCE_BARRIER>* begun)
+{
+	auto& tracked = GetTracked(resource);
+	if (subresource == AllSubresources)
+	{
+		if (tracked.subresources.empty())
+		{
+			AddBarrier(resource, tracked.state, after, AllSubresources, flags, begun);
+		}
+		else
+		{
+			// Only the subresources in another state need a barrier.
+			for (UINT i = 0; i < tracked.subresourceCount; i++)
+				AddBarrier(resource, tracked.subresources[i], after, i, flags, begun);
+			tracked.subresources.clear();
+		}
+		tracked.state = after;
+		return;
+	}
+
+	if (tracked.subresources.empty())
+	{
+		if (tracked.state == after)
+			return;
+		tracked.subresources.assign(tracked.subresourceCount, tracked.state);
+	}
+	AddBarrier(resource, tracked.subresources[subresource], after, subresource, flags, begun);
+	tracked.subresources[subresource] = after;
+
+	// Back to one state for the whole resource when every subresource agrees.
+	if (std::all_of(tracked.subresources.begin(), tracked.subresources.end(), [after](D3D12_RESOURCE_STATES s) { return s == after; }))
+	{
+		tracked.subresources.clear();
+		tracked.state = after;
+	}
+}
+
+void ResourceStateTracker::AddBarrier(ID3D12Resource* resource, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after,
+	UINT subresource, D3D12_RESOURCE_BARRIER_FLAGS flags, std::vector<D3D12_RESOURCE_BARRIER>* begun)
+{
+	if (before == after)
+		return;
+
+	// Fold into a queued transition of the same subresource, e.g. A->B then B->C becomes A->C.
+	if (flags == D3D12_RESOURCE_BARRIER_FLAG_NONE)
+	{
+		for (auto it = m_pending.begin(); it != m_pending.end(); ++it)
+		{
+			auto& pending = it->Transition;
+			if (it->Type != D3D12_RESOURCE_BARRIER_TYPE_TRANSITION || it->Flags != D3D12_RESOURCE_BARRIER_FLAG_NONE ||
+				pending.pResource != resource || pending.Subresource != subresource || pending.StateAfter != before)
+				continue;
+			if (pending.StateBefore == after)
+				m_pending.erase(it);
+			else
+				pending.StateAfter = after;
+			return;
+		}
+	}
+
+	auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(resource, before, after, subresource, flags);
+	m_pending.push_back(barrier);
+	if (begun)
+		begun->push_back(barrier);
+}
+
+ResourceStateTracker::TrackedResource& ResourceStateTracker::GetTracked(ID3D12Resource* resource)
+{
+	auto it = m_resources.find(resource);
+	if (it == m_resources.end())
+		throw std::runtime_error("Resource is not registered in the state tracker.");
+	return it->second;
+}
\ No newline at end of file
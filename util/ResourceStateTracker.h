@@ -0,0 +1,59 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <d3d12.h>
+
+#include "d3dx12.h"
+#include <unordered_map>
+#include <vector>
+
+// Records the state of each resource, per subresource when they differ, and generates the transitions
+// needed to use a resource in a new state. Transitions are queued and issued by Flush() as one
+// ResourceBarrier call, which should be done right before the draw or copy using them.
+// States are those at the end of the recorded work, so lists must be executed in the order they record.
+// Resources are keyed by address; registering a new resource at the same address replaces the old one.
+class ResourceStateTracker {
+public:
+	static const UINT AllSubresources = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+
+	void Register(ID3D12Resource* resource, D3D12_RESOURCE_STATES state);
+	void Unregister(ID3D12Resource* resource);
+	bool IsRegistered(ID3D12Resource* resource) const { return m_resources.count(resource) > 0; }
+	D3D12_RESOURCE_STATES GetState(ID3D12Resource* resource, UINT subresource = 0) const;
+	UINT GetSubresourceCount(ID3D12Resource* resource) const;
+
+	// Queue the transitions of the subresource, or of every subresource, to the state.
+	void Transition(ID3D12Resource* resource, D3D12_RESOURCE_STATES after, UINT subresource = AllSubresources);
+	// Split barrier. The transition begins at the next Flush() and must be ended with EndTransition()
+	// before the resource is used. The GPU may overlap the transition with the work in between.
+	void BeginTransition(ID3D12Resource* resource, D3D12_RESOURCE_STATES after, UINT subresource = AllSubresources);
+	void EndTransition(ID3D12Resource* resource);
+	void UAVBarrier(ID3D12Resource* resource);
+
+	// Record the queued barriers with one call. Return the number of barriers.
+	UINT Flush(ID3D12GraphicsCommandList* commandList);
+	// Record only the queued barriers of the resources. The others stay queued in their order,
+	// e.g. when the list belongs to another submission than the one queueing them.
+	UINT Flush(ID3D12GraphicsCommandList* commandList, ID3D12Resource* const* resources, UINT resourceCount);
+	UINT GetPendingCount() const { return UINT(m_pending.size()); }
+
+private:
+	struct TrackedResource {
+		D3D12_RESOURCE_STATES state;
+		// States of each subresource. Empty while all subresources are in the same state.
+		std::vector<D3D12_RESOURCE_STATES> subresources;
+		UINT subresourceCount;
+	};
+
+	void AddTransitions(ID3D12Resource* resource, D3D12_RESOURCE_STATES after, UINT subresource,
+		D3D12_RESOURCE_BARRIER_FLAGS flags, std::vector<D3D12_RESOURCE_BARRIER>* begun);
+	void AddBarrier(ID3D12Resource* resource, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after,
+		UINT subresource, D3D12_RESOURCE_BARRIER_FLAGS flags, std::vector<D3D12_RESOURCE_BARRIER>* begun);
+	TrackedResource& GetTracked(ID3D12Resource* resource);
+
+	std::unordered_map<ID3D12Resource*, TrackedResource> m_resources;
+	// Begun split barriers per resource, which are ended by EndTransition().
+	std::unordered_map<ID3D12Resource*, std::vector<D3D12_RESOURCE_BARRIER>> m_splits;
+	std::vector<D3D12_RESOURCE_BARRIER> m_pending;
+};
\ No newline at end of file
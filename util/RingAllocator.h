@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+// Offset allocator over a fixed size ring.
+// Allocations are grouped by frame and a frame's range is reclaimed once its fence value has completed.
+// This class has no dependency on D3D12, so it can be shared by upload buffers and descriptor heaps.
+class RingAllocator {
+public:
+	static const uint64_t InvalidOffset = ~0ull;
+
+	RingAllocator() : m_size(0), m_head(0), m_tail(0), m_used(0), m_frameSize(0) {}
+	explicit RingAllocator(uint64_t size) { Reset(size); }
+
+	void Reset(uint64_t size)
+	{
+		m_size = size;
+		m_head = m_tail = m_used = m_frameSize = 0;
+		m_frames.clear();
+	}
+
+	// Returns InvalidOffset when the ring doesn't have enough space.
+	uint64_t Allocate(uint64_t size, uint64_t alignment = 1)
+	{
+		if (size == 0 || size > m_size || m_used == m_size)
+			return InvalidOffset;
+
+		uint64_t offset = AlignUp(m_head, alignment);
+		if (m_head >= m_tail)
+		{
+			// Free ranges are [head, size) and [0, tail).
+			if (offset + size > m_size)
+			{
+				if (size > m_tail)
+					return InvalidOffset;
+				offset = 0;
+			}
+		}
+		else if (offset + size > m_tail)
+		{
+			return InvalidOffset;
+		}
+
+		// Padding skipped at the end of ring or for alignment is owned by this frame too.
+		const uint64_t consumed = (offset >= m_head) ? (offset + size - m_head) : (m_size - m_head + offset + size);
+		m_used += consumed;
+		m_frameSize += consumed;
+		m_head = offset + size;
+		if (m_head == m_size)
+			m_head = 0;
+		return offset;
+	}
+
+	// Close the allocations of current frame with the fence value signaled after them.
+	void FinishFrame(uint64_t fenceValue)
+	{
+		if (m_frameSize == 0)
+			return;
+		m_frames.push_back({ fenceValue, m_head, m_frameSize });
+		m_frameSize = 0;
+	}
+
+	// Reclaim every frame whose fence value is lower than or equal to completedValue.
+	void Retire(uint64_t completedValue)
+	{
+		while (!m_frames.empty() && m_frames.front().fenceValue <= completedValue)
+		{
+			m_tail = m_frames.front().head;
+			m_used -= m_frames.front().size;
+			m_frames.pop_front();
+		}
+		// A drained ring starts over at 0, so an allocation can use the whole ring again.
+		if (m_used == 0)
+			m_head = m_tail = 0;
+	}
+
+	uint64_t GetSize() const { return m_size; }
+	uint64_t GetUsedSize() const { return m_used; }
+
+	static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+private:
+	struct FrameMark {
+		uint64_t fenceValue;
+		uint64_t head;	// Head position at the end of frame.
+		uint64_t size;	// Consumed size by the frame.
+	};
+
+	uint64_t m_size;
+	uint64_t m_head;
+	uint64_t m_tail;
+	uint64_t m_used;
+	uint64_t m_frameSize;
+	std::deque<FrameMark> m_frames;
+};
\ No newline at end of file
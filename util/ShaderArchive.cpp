@@ -0,0 +1,249 @@
+#include "ShaderArchive.h"
+#include "ShaderIncludeHandler.h"
+#include "util.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+	// Blob alignment in the file. DXIL containers are read as 4 byte words.
+	const uint64_t BlobAlignment = 16;
+
+	uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+}
+
+void ShaderArchiveWriter::Add(uint64_t key, ID3DBlob* blob, const std::vector<ShaderDependency>& sources)
+{
+	std::vector<char> records;
+	auto append = [&records](const void* p, size_t size) {
+		records.insert(records.end(), static_cast<const char*>(p), static_cast<const char*>(p) + size);
+	};
+	for (const auto& source : sources)
+	{
+		const uint32_t length = uint32_t(source.path.size());
+		append(&source.hash, sizeof(source.hash));
+		append(&length, sizeof(length));
+		append(source.path.data(), length * sizeof(wchar_t));
+	}
+
+	for (auto& item : m_items)
+	{
+		if (item.key == key)
+		{
+			item.blob = blob;
+			item.sources = std::move(records);
+			return;
+		}
+	}
+	m_items.push_back({ key, blob, std::move(records) });
+}
+
+void ShaderArchiveWriter::Add(const ShaderCompileJob& job, ID3DBlob* blob, const std::vector<ShaderDependency>& includes)
+{
+	auto file = ShaderIncludeCache::Get().Load(job.fileName);
+	if (!file)
+		throw std::runtime_error("shader not found");
+	std::vector<ShaderDependency> sources = { { job.fileName, file->hash } };
+	sources.insert(sources.end(), includes.begin(), includes.end());
+	Add(ShaderArchive::MakeKey(job), blob, sources);
+}
+
+bool ShaderArchiveWriter::Write(const std::wstring& fileName)
+{
+	std::sort(m_items.begin(), m_items.end(), [](const Item& a, const Item& b) { return a.key < b.key; });
+
+	ShaderArchiveHeader header = {
+		ShaderArchive::Magic, ShaderArchive::Version, uint32_t(m_items.size()), 0, ShaderCompiler::GetFingerprint()
+	};
+	std::vector<ShaderArchiveEntry> entries(m_items.size());
+	uint64_t offset = AlignUp(sizeof(header) + sizeof(ShaderArchiveEntry) * entries.size(), BlobAlignment);
+	for (size_t i = 0; i < m_items.size(); i++)
+	{
+		// The source records follow each blob.
+		const uint64_t size = m_items[i].blob->GetBufferSize();
+		entries[i] = { m_items[i].key, offset, size, offset + size, m_items[i].sources.size() };
+		offset = AlignUp(offset + size + m_items[i].sources.size(), BlobAlignment);
+	}
+
+	std::ofstream outfile(fileName, std::ios::binary | std::ios::trunc);
+	if (!outfile)
+		return false;
+	outfile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	outfile.write(reinterpret_cast<const char*>(entries.data()), sizeof(ShaderArchiveEntry) * entries.size());
+	for (size_t i = 0; i < m_items.size(); i++)
+	{
+		// Pad up to the blob offset.
+		static const char zeros[BlobAlignment] = {};
+		outfile.write(zeros, std::streamsize(entries[i].offset - uint64_t(outfile.tellp())));
+		outfile.write(static_cast<const char*>(m_items[i].blob->GetBufferPointer()), entries[i].size);
+		outfile.write(m_items[i].sources.data(), std::streamsize(m_items[i].sources.size()));
+	}
+	return bool(outfile);
+}
+
+bool ShaderArchiveWriter::Pack(const std::vector<ShaderCompileJob>& jobs, ShaderCompileService& service, const std::wstring& fileName)
+{
+	ShaderArchiveWriter writer;
+	auto futures = service.Submit(jobs);
+	for (size_t i = 0; i < futures.size(); i++)
+	{
+		auto result = futures[i].get();
+		if (FAILED(result.hr))
+		{
+			if (result.error)
+				Util::Log("%s\n", static_cast<const char*>(result.error->GetBufferPointer()));
+			throw std::runtime_error("Failed CompileFromFile");
+		}
+		writer.Add(jobs[i], result.shader.Get(), result.dependencies);
+	}
+	return writer.Write(fileName);
+}
+
+uint64_t ShaderArchive::MakeKey(
+	const std::wstring& fileName, const std::wstring& entryPoint, const std::wstring& profile,
+	const std::vector<ShaderDefine>& defines)
+{
+	ShaderHasher hasher;
+	hasher.Add(fileName).Add(entryPoint).Add(profile);
+	for (const auto& define : defines)
+		hasher.Add(define.name).Add(define.value);
+	return hasher.Get();
+}
+
+uint64_t ShaderArchive::MakeKey(const ShaderCompileJob& job)
+{
+	return MakeKey(job.fileName, job.entryPoint, job.profile, job.defines);
+}
+
+bool ShaderArchive::Open(const std::wstring& fileName, bool checkSources)
+{
+	Close();
+
+	m_file = CreateFileW(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_file, &size) || uint64_t(size.QuadPart) < sizeof(ShaderArchiveHeader))
+	{
+		Close();
+		return false;
+	}
+	m_size = uint64_t(size.QuadPart);
+
+	m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping != nullptr)
+		m_view = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (m_view == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	auto header = reinterpret_cast<const ShaderArchiveHeader*>(m_view);
+	if (header->magic != Magic || header->version != Version ||
+		sizeof(ShaderArchiveHeader) + sizeof(ShaderArchiveEntry) * uint64_t(header->count) > m_size)
+	{
+		Close();
+		return false;
+	}
+	if (header->compilerFingerprint != ShaderCompiler::GetFingerprint())
+	{
+		Util::Log("Shader archive was packed by another compiler or flags, ignored: %ls\n", fileName.c_str());
+		Close();
+		return false;
+	}
+	m_entries = reinterpret_cast<const ShaderArchiveEntry*>(header + 1);
+	m_count = header->count;
+	m_checkSources = checkSources;
+	m_blobs.resize(m_count);
+	for (UINT i = 0; i < m_count; i++)
+	{
+		if (m_entries[i].offset + m_entries[i].size <= m_size)
+			m_blobs[i] = ShaderArchiveBlob(m_view + m_entries[i].offset, SIZE_T(m_entries[i].size));
+	}
+	return true;
+}
+
+void ShaderArchive::Close()
+{
+	if (m_view != nullptr)
+		UnmapViewOfFile(m_view);
+	if (m_mapping != nullptr)
+		CloseHandle(m_mapping);
+	if (m_file != INVALID_HANDLE_VALUE)
+		CloseHandle(m_file);
+	m_file = INVALID_HANDLE_VALUE;
+	m_mapping = nullptr;
+	m_view = nullptr;
+	m_size = 0;
+	m_entries = nullptr;
+	m_count = 0;
+	m_blobs.clear();
+}
+
+bool ShaderArchive::Find(uint64_t key, D3D12_SHADER_BYTECODE& bytecode) const
+{
+	auto entry = FindEntry(key);
+	if (entry == nullptr)
+		return false;
+
+	bytecode.pShaderBytecode = m_view + entry->offset;
+	bytecode.BytecodeLength = SIZE_T(entry->size);
+	return true;
+}
+
+bool ShaderArchive::Find(const ShaderCompileJob& job, D3D12_SHADER_BYTECODE& bytecode, ID3DBlob** blob)
+{
+	auto entry = FindEntry(MakeKey(job));
+	if (entry == nullptr)
+		return false;
+
+	bytecode.pShaderBytecode = m_view + entry->offset;
+	bytecode.BytecodeLength = SIZE_T(entry->size);
+	*blob = &m_blobs[entry - m_entries];
+	return true;
+}
+
+const ShaderArchiveEntry* ShaderArchive::FindEntry(uint64_t key) const
+{
+	auto end = m_entries + m_count;
+	auto it = std::lower_bound(m_entries, end, key,
+		[](const ShaderArchiveEntry& entry, uint64_t key) { return entry.key < key; });
+	if (it == end || it->key != key || it->offset + it->size > m_size || it->sourcesOffset + it->sourcesSize > m_size)
+		return nullptr;
+	if (m_checkSources && !IsUpToDate(*it))
+		return nullptr;
+	return it;
+}
+
+bool ShaderArchive::IsUpToDate(const ShaderArchiveEntry& entry) const
+{
+	auto p = m_view + entry.sourcesOffset;
+	const auto end = p + entry.sourcesSize;
+	while (p + sizeof(uint64_t) + sizeof(uint32_t) <= end)
+	{
+		uint64_t hash;
+		uint32_t length;
+		memcpy(&hash, p, sizeof(hash));
+		memcpy(&length, p + sizeof(hash), sizeof(length));
+		p += sizeof(hash) + sizeof(length);
+		if (p + length * sizeof(wchar_t) > end)
+			return false;
+		std::wstring path(length, L'\0');
+		memcpy(&path[0], p, length * sizeof(wchar_t));
+		p += length * sizeof(wchar_t);
+
+		auto file = ShaderIncludeCache::Get().Load(path);
+		if (file && file->hash != hash)
+		{
+			Util::Log("Shader archive entry is older than %ls, compiling instead.\n", path.c_str());
+			return false;
+		}
+	}
+	return true;
+}
\ No newline at end of file
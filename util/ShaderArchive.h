@@ -0,0 +1,125 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include <d3d12.h>
+
+#include <wrl.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ShaderCompileService.h"
+
+// Layout of an archive file. Blobs follow the index, which is sorted by key.
+struct ShaderArchiveHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t count;
+	uint32_t reserved;
+	uint64_t compilerFingerprint; // ShaderCompiler::GetFingerprint() of the packing process.
+};
+
+struct ShaderArchiveEntry {
+	uint64_t key;
+	uint64_t offset;
+	uint64_t size;
+	// Source files of the shader, the main file and its includes, as (hash, path length, path) records.
+	uint64_t sourcesOffset;
+	uint64_t sourcesSize;
+};
+
+// Writes compiled shaders into one archive file. Used as an offline packing step.
+class ShaderArchiveWriter {
+public:
+	// sources are the files the blob was compiled from, with their hashes at that time.
+	void Add(uint64_t key, ID3DBlob* blob, const std::vector<ShaderDependency>& sources);
+	// The job's file is hashed now and recorded before the included files.
+	void Add(const ShaderCompileJob& job, ID3DBlob* blob, const std::vector<ShaderDependency>& includes);
+	bool Write(const std::wstring& fileName);
+
+	// Compile every job in parallel and write the results. Throws when a shader fails to compile.
+	static bool Pack(const std::vector<ShaderCompileJob>& jobs, ShaderCompileService& service, const std::wstring& fileName);
+
+private:
+	struct Item {
+		uint64_t key;
+		Microsoft::WRL::ComPtr<ID3DBlob> blob;
+		std::vector<char> sources;
+	};
+	std::vector<Item> m_items;
+};
+
+// ID3DBlob over bytes it doesn't own, for reflecting a shader in the mapping without copying it.
+// The archive owns the blobs, reference counting doesn't free them. Valid until the archive is closed.
+class ShaderArchiveBlob : public ID3DBlob {
+public:
+	ShaderArchiveBlob() : m_data(nullptr), m_size(0) {}
+	ShaderArchiveBlob(const void* data, SIZE_T size) : m_data(data), m_size(size) {}
+
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** object) override
+	{
+		if (riid == __uuidof(IUnknown) || riid == __uuidof(ID3DBlob))
+		{
+			*object = static_cast<ID3DBlob*>(this);
+			return S_OK;
+		}
+		*object = nullptr;
+		return E_NOINTERFACE;
+	}
+	ULONG STDMETHODCALLTYPE AddRef() override { return 1; }
+	ULONG STDMETHODCALLTYPE Release() override { return 1; }
+	LPVOID STDMETHODCALLTYPE GetBufferPointer() override { return const_cast<void*>(m_data); }
+	SIZE_T STDMETHODCALLTYPE GetBufferSize() override { return m_size; }
+
+private:
+	const void* m_data;
+	SIZE_T m_size;
+};
+
+// Read only view of an archive mapped into memory.
+// The bytecode and the blobs returned by Find() point into the mapping and stay valid until Close().
+// An archive packed by another compiler or flags is not opened. When checkSources is given to Open(),
+// an entry whose source files have changed since packing is not found, so callers compile the current
+// sources instead. The check reads every source of the shader, so it is meant for development only.
+// Source files which don't exist are not checked, the archive can be used without them.
+class ShaderArchive {
+public:
+	static const uint32_t Magic = 0x41535844; // 'DXSA'
+	static const uint32_t Version = 2;
+
+	ShaderArchive() = default;
+	~ShaderArchive() { Close(); }
+	ShaderArchive(const ShaderArchive&) = delete;
+	ShaderArchive& operator=(const ShaderArchive&) = delete;
+
+	static uint64_t MakeKey(
+		const std::wstring& fileName, const std::wstring& entryPoint, const std::wstring& profile,
+		const std::vector<ShaderDefine>& defines);
+	static uint64_t MakeKey(const ShaderCompileJob& job);
+
+	bool Open(const std::wstring& fileName, bool checkSources = false);
+	void Close();
+	bool IsOpen() const { return m_view != nullptr; }
+
+	bool Find(uint64_t key, D3D12_SHADER_BYTECODE& bytecode) const;
+	bool Find(const ShaderCompileJob& job, D3D12_SHADER_BYTECODE& bytecode) const { return Find(MakeKey(job), bytecode); }
+	// Same as above with a blob over the bytecode, e.g. for the reflection.
+	bool Find(const ShaderCompileJob& job, D3D12_SHADER_BYTECODE& bytecode, ID3DBlob** blob);
+
+	UINT GetCount() const { return m_count; }
+
+private:
+	const ShaderArchiveEntry* FindEntry(uint64_t key) const;
+	bool IsUpToDate(const ShaderArchiveEntry& entry) const;
+
+	HANDLE m_file = INVALID_HANDLE_VALUE;
+	HANDLE m_mapping = nullptr;
+	const uint8_t* m_view = nullptr;
+	uint64_t m_size = 0;
+	const ShaderArchiveEntry* m_entries = nullptr;
+	UINT m_count = 0;
+	bool m_checkSources = false;
+	// One per entry, made together in Open().
+	std::vector<ShaderArchiveBlob> m_blobs;
+};
\ No newline at end of file
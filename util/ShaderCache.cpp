@@ -0,0 +1,118 @@
+#include "ShaderCache.h"
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#if _MSC_VER > 1922
+#define _SILENCE_EXPERIMENTAL_FILESYSTEM_DEPRECATION_WARNING
+#endif
+#include <experimental/filesystem>
+
+bool ShaderCache::Load(uint64_t key, ComPtr<ID3DBlob>& blob, const wchar_t* extension) const
+{
+	std::ifstream infile(GetPath(key, extension), std::ios::binary);
+	if (!infile)
+		return false;
+
+	std::vector<char> data;
+	data.resize(size_t(infile.seekg(0, infile.end).tellg()));
+	infile.seekg(0, infile.beg).read(data.data(), data.size());
+	if (!infile || data.empty())
+		return false;
+
+	blob.Attach(new ShaderBlob(std::move(data)));
+	return true;
+}
+
+void ShaderCache::Store(uint64_t key, ID3DBlob* blob, const wchar_t* extension) const
+{
+	WriteFile(GetPath(key, extension), blob->GetBufferPointer(), blob->GetBufferSize());
+}
+
+bool ShaderCache::LoadDependencies(uint64_t key, std::vector<ShaderDependency>& dependencies) const
+{
+	// Format: count, then (hash, length, path characters) for each file.
+	std::ifstream infile(GetPath(key, L".deps"), std::ios::binary);
+	if (!infile)
+		return false;
+
+	uint32_t count = 0;
+	infile.read(reinterpret_cast<char*>(&count), sizeof(count));
+	dependencies.resize(count);
+	for (auto& dependency : dependencies)
+	{
+		uint32_t length = 0;
+		infile.read(reinterpret_cast<char*>(&dependency.hash), sizeof(dependency.hash));
+		infile.read(reinterpret_cast<char*>(&length), sizeof(length));
+		dependency.path.resize(length);
+		infile.read(reinterpret_cast<char*>(&dependency.path[0]), length * sizeof(wchar_t));
+	}
+	return bool(infile);
+}
+
+void ShaderCache::StoreDependencies(uint64_t key, const std::vector<ShaderDependency>& dependencies) const
+{
+	std::vector<char> data;
+	auto append = [&data](const void* p, size_t size) {
+		data.insert(data.end(), static_cast<const char*>(p), static_cast<const char*>(p) + size);
+	};
+	const uint32_t count = uint32_t(dependencies.size());
+	append(&count, sizeof(count));
+	for (const auto& dependency : dependencies)
+	{
+		const uint32_t length = uint32_t(dependency.path.size());
+		append(&dependency.hash, sizeof(dependency.hash));
+		append(&length, sizeof(length));
+		append(dependency.path.data(), length * sizeof(wchar_t));
+	}
+	WriteFile(GetPath(key, L".deps"), data.data(), data.size());
+}
+
+void ShaderCache::WriteFile(const std::wstring& filePath, const void* data, size_t size) const
+{
+	using namespace std::experimental::filesystem;
+
+	std::error_code ec;
+	create_directories(path(m_directory), ec);
+
+	// Write to a temporary file first, so that a broken file never has the key name.
+	// The name is unique per thread since workers may store the same key at once.
+	std::wstringstream tmpName;
+	tmpName << filePath << L"." << std::this_thread::get_id() << L".tmp";
+	const auto tmpPath = tmpName.str();
+	{
+		std::ofstream outfile(tmpPath, std::ios::binary | std::ios::trunc);
+		if (!outfile)
+			return;
+		outfile.write(static_cast<const char*>(data), size);
+	}
+	remove(path(filePath), ec);
+	rename(path(tmpPath), path(filePath), ec);
+}
+
+std::wstring ShaderCache::GetPath(uint64_t key, const wchar_t* extension) const
+{
+	wchar_t name[17];
+	swprintf_s(name, L"%016llx", static_cast<unsigned long long>(key));
+	return m_directory + L"/" + name + extension;
+}
+
+uint64_t ShaderCache::GetCompilerVersion()
+{
+	static const uint64_t version = []() {
+		ShaderHasher hasher;
+		wchar_t modulePath[MAX_PATH] = {};
+		HMODULE module = GetModuleHandleW(L"dxcompiler.dll");
+		if (module && GetModuleFileNameW(module, modulePath, MAX_PATH))
+		{
+			WIN32_FILE_ATTRIBUTE_DATA attributes{};
+			if (GetFileAttributesExW(modulePath, GetFileExInfoStandard, &attributes))
+			{
+				hasher.Add(&attributes.nFileSizeLow, sizeof(attributes.nFileSizeLow));
+				hasher.Add(&attributes.ftLastWriteTime, sizeof(attributes.ftLastWriteTime));
+			}
+		}
+		return hasher.Get();
+	}();
+	return version;
+}
\ No newline at end of file
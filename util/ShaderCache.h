@@ -0,0 +1,108 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <d3d12.h>
+#include <d3dcommon.h>
+
+#include <wrl.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ID3DBlob holding its bytes in memory. Used for the blobs loaded from disk without DXC.
+class ShaderBlob : public ID3DBlob {
+public:
+	explicit ShaderBlob(std::vector<char>&& data) : m_refCount(1), m_data(std::move(data)) {}
+	virtual ~ShaderBlob() {}
+
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** object) override
+	{
+		if (riid == __uuidof(IUnknown) || riid == __uuidof(ID3DBlob))
+		{
+			*object = static_cast<ID3DBlob*>(this);
+			AddRef();
+			return S_OK;
+		}
+		*object = nullptr;
+		return E_NOINTERFACE;
+	}
+	ULONG STDMETHODCALLTYPE AddRef() override { return ++m_refCount; }
+	ULONG STDMETHODCALLTYPE Release() override
+	{
+		const ULONG count = --m_refCount;
+		if (count == 0)
+			delete this;
+		return count;
+	}
+	LPVOID STDMETHODCALLTYPE GetBufferPointer() override { return m_data.data(); }
+	SIZE_T STDMETHODCALLTYPE GetBufferSize() override { return m_data.size(); }
+
+private:
+	std::atomic<ULONG> m_refCount;
+	std::vector<char> m_data;
+};
+
+// A file included by a shader and the hash of its contents when the shader was compiled.
+struct ShaderDependency {
+	std::wstring path;
+	uint64_t hash;
+};
+
+// FNV-1a 64bit hash. Stable across runs and machines, so it can name files on disk.
+class ShaderHasher {
+public:
+	ShaderHasher() : m_hash(14695981039346656037ull) {}
+
+	ShaderHasher& Add(const void* data, size_t size)
+	{
+		auto bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; i++)
+		{
+			m_hash ^= bytes[i];
+			m_hash *= 1099511628211ull;
+		}
+		return *this;
+	}
+	ShaderHasher& Add(const std::wstring& str)
+	{
+		// Include the terminator to separate consecutive strings.
+		return Add(str.c_str(), (str.size() + 1) * sizeof(wchar_t));
+	}
+	ShaderHasher& Add(uint64_t value) { return Add(&value, sizeof(value)); }
+
+	uint64_t Get() const { return m_hash; }
+
+private:
+	uint64_t m_hash;
+};
+
+// Content addressed cache of compiled DXIL on disk.
+// The key is made by the caller from everything which affects the output.
+class ShaderCache {
+public:
+	template<class T>
+	using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+	explicit ShaderCache(const std::wstring& directory = L"ShaderCache") : m_directory(directory) {}
+
+	// The extension separates the kinds of data stored for the same key.
+	bool Load(uint64_t key, ComPtr<ID3DBlob>& blob, const wchar_t* extension = L".dxil") const;
+	void Store(uint64_t key, ID3DBlob* blob, const wchar_t* extension = L".dxil") const;
+
+	// Include files of the shader stored with the key.
+	bool LoadDependencies(uint64_t key, std::vector<ShaderDependency>& dependencies) const;
+	void StoreDependencies(uint64_t key, const std::vector<ShaderDependency>& dependencies) const;
+
+	std::wstring GetPath(uint64_t key, const wchar_t* extension = L".dxil") const;
+	const std::wstring& GetDirectory() const { return m_directory; }
+
+	// Identifies the DXC binary loaded in the process by its size and timestamp.
+	static uint64_t GetCompilerVersion();
+
+private:
+	void WriteFile(const std::wstring& filePath, const void* data, size_t size) const;
+
+	std::wstring m_directory;
+};
\ No newline at end of file
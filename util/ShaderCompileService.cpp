@@ -0,0 +1,72 @@
+#include "ShaderCompileService.h"
+#include <algorithm>
+
+ShaderCompileService::ShaderCompileService(UINT workerCount, const std::wstring& cacheDirectory) : m_cacheDirectory(cacheDirectory)
+{
+	m_workerCount = workerCount > 0 ? workerCount : std::max(1u, std::thread::hardware_concurrency());
+}
+
+ShaderCompileService::~ShaderCompileService()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_exit = true;
+	}
+	m_condition.notify_all();
+	for (auto& worker : m_workers)
+		worker.join();
+}
+
+std::future<ShaderCompileResult> ShaderCompileService::Submit(const ShaderCompileJob& job)
+{
+	std::packaged_task<ShaderCompileResult(ShaderCompiler&)> task([job](ShaderCompiler& compiler) {
+		ShaderCompileResult result;
+		result.hr = compiler.CompileFromFile(
+			job.fileName, job.entryPoint, job.profile, job.defines, result.shader, result.error, &result.dependencies);
+		return result;
+	});
+	auto future = task.get_future();
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_workers.empty())
+			Start();
+		m_tasks.push_back(std::move(task));
+	}
+	m_condition.notify_one();
+	return future;
+}
+
+std::vector<std::future<ShaderCompileResult>> ShaderCompileService::Submit(const std::vector<ShaderCompileJob>& jobs)
+{
+	std::vector<std::future<ShaderCompileResult>> futures;
+	futures.reserve(jobs.size());
+	for (const auto& job : jobs)
+		futures.push_back(Submit(job));
+	return futures;
+}
+
+void ShaderCompileService::Start()
+{
+	for (UINT i = 0; i < m_workerCount; i++)
+		m_workers.emplace_back(&ShaderCompileService::WorkerMain, this);
+}
+
+void ShaderCompileService::WorkerMain()
+{
+	// DXC instances of this thread. They are created on the first cache miss.
+	ShaderCompiler compiler(m_cacheDirectory);
+	for (;;)
+	{
+		std::packaged_task<ShaderCompileResult(ShaderCompiler&)> task;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this]() { return m_exit || !m_tasks.empty(); });
+			if (m_exit && m_tasks.empty())
+				return;
+			task = std::move(m_tasks.front());
+			m_tasks.pop_front();
+		}
+		// Exceptions (e.g. shader not found) are delivered through the future.
+		task(compiler);
+	}
+}
\ No newline at end of file
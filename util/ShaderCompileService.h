@@ -0,0 +1,50 @@
+#pragma once
+
+#include "ShaderCompiler.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+struct ShaderCompileJob {
+	std::wstring fileName;
+	std::wstring entryPoint = L"main";
+	std::wstring profile;
+	std::vector<ShaderDefine> defines;
+};
+
+struct ShaderCompileResult {
+	HRESULT hr = E_FAIL;
+	Microsoft::WRL::ComPtr<ID3DBlob> shader;
+	Microsoft::WRL::ComPtr<ID3DBlob> error;
+	std::vector<ShaderDependency> dependencies; // Files included by the shader.
+};
+
+// Compiles shaders in parallel on worker threads.
+// Each worker keeps its own ShaderCompiler, so DXC instances are created once per thread and never shared.
+class ShaderCompileService {
+public:
+	// 0 means the number of hardware threads. Workers are started on the first Submit().
+	// The compilers of the workers share the disk cache in cacheDirectory.
+	explicit ShaderCompileService(UINT workerCount = 0, const std::wstring& cacheDirectory = L"ShaderCache");
+	~ShaderCompileService();
+
+	std::future<ShaderCompileResult> Submit(const ShaderCompileJob& job);
+	std::vector<std::future<ShaderCompileResult>> Submit(const std::vector<ShaderCompileJob>& jobs);
+
+	UINT GetWorkerCount() const { return m_workerCount; }
+
+private:
+	void Start();
+	void WorkerMain();
+
+	UINT m_workerCount;
+	std::wstring m_cacheDirectory;
+	std::vector<std::thread> m_workers;
+	std::deque<std::packaged_task<ShaderCompileResult(ShaderCompiler&)>> m_tasks;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	bool m_exit = false;
+};
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include "ShaderCompiler.h"
+#include "ShaderIncludeHandler.h"
+#include "util.h"
+
+// For DirectX Shader Compiler.
+#include <dxcapi.h>
+#pragma comment(lib, "dxcompiler.lib")
+
+namespace {
+	const LPCWSTR CompilerFlags[] = {
+#if _DEBUG
+		L"/Zi", L"/O0",
+#else
+		L"/O2" // Optimizing in Release Build.
+#endif
+	};
+}
+
+ShaderCompiler::ShaderCompiler(const std::wstring& cacheDirectory) : m_cache(cacheDirectory)
+{
+}
+
+ShaderCompiler::~ShaderCompiler()
+{
+}
+
+uint64_t ShaderCompiler::GetFingerprint()
+{
+	ShaderHasher hasher;
+	for (auto flag : CompilerFlags)
+		hasher.Add(std::wstring(flag));
+	hasher.Add(ShaderCache::GetCompilerVersion());
+	return hasher.Get();
+}
+
+HRESULT ShaderCompiler::CompileFromFile(
+	const std::wstring& fileName, const std::wstring& entryPoint, const std::wstring& profile,
+	const std::vector<ShaderDefine>& defines, ComPtr<ID3DBlob>& shaderBlob, ComPtr<ID3DBlob>& errorBlob,
+	std::vector<ShaderDependency>* dependencies)
+{
+	using namespace std::experimental::filesystem;
+
+	path filePath(fileName);
+	std::ifstream infile(filePath, std::ios::binary);
+	std::vector<char> srcData;
+	if (!infile)
+		throw std::runtime_error("shader not found");
+	srcData.resize(uint32_t(infile.seekg(0, infile.end).tellg()));
+	infile.seekg(0, infile.beg).read(srcData.data(), srcData.size());
+
+	// Everything which changes the output makes the key.
+	ShaderHasher hasher;
+	hasher.Add(srcData.data(), srcData.size());
+	hasher.Add(entryPoint).Add(profile);
+	for (const auto& define : defines)
+		hasher.Add(define.name).Add(define.value);
+	hasher.Add(GetFingerprint());
+	const auto key = hasher.Get();
+
+	// The key only covers the main file. The included files are validated by their recorded hashes,
+	// which are rehashed only when their timestamps have changed.
+	std::vector<ShaderDependency> cachedDependencies;
+	if (m_cache.LoadDependencies(key, cachedDependencies) &&
+		ShaderIncludeCache::Get().IsUpToDate(cachedDependencies) &&
+		m_cache.Load(key, shaderBlob))
+	{
+		Util::Log("Shader cache hit: %ls\n", fileName.c_str());
+		if (dependencies)
+			*dependencies = std::move(cachedDependencies);
+		return S_OK;
+	}
+
+	// Compiling process by DXC (DirectX Shader Compiler).
+	CreateCompiler();
+	ComPtr<IDxcBlobEncoding> source;
+	ComPtr<IDxcOperationResult> dxcResult;
+	m_library->CreateBlobWithEncodingFromPinned(srcData.data(), UINT(srcData.size()), CP_ACP, &source);
+
+	std::vector<DxcDefine> dxcDefines;
+	for (const auto& define : defines)
+		dxcDefines.push_back({ define.name.c_str(), define.value.empty() ? nullptr : define.value.c_str() });
+
+	ComPtr<ShaderIncludeHandler> includeHandler;
+	includeHandler.Attach(new ShaderIncludeHandler(m_library.Get()));
+	m_compiler->Compile(source.Get(), filePath.wstring().c_str(),
+		entryPoint.c_str(), profile.c_str(),
+		CompilerFlags, _countof(CompilerFlags),
+		dxcDefines.data(), UINT(dxcDefines.size()),
+		includeHandler.Get(),
+		&dxcResult);
+
+	HRESULT hr;
+	dxcResult->GetStatus(&hr);
+	if (SUCCEEDED(hr))
+	{
+		dxcResult->GetResult(
+			reinterpret_cast<IDxcBlob**>(shaderBlob.ReleaseAndGetAddressOf())
+		);
+		m_cache.Store(key, shaderBlob.Get());
+		m_cache.StoreDependencies(key, includeHandler->GetDependencies());
+		if (dependencies)
+			*dependencies = includeHandler->GetDependencies();
+	}
+	else
+	{
+		dxcResult->GetErrorBuffer(
+			reinterpret_cast<IDxcBlobEncoding**>(errorBlob.ReleaseAndGetAddressOf())
+		);
+	}
+	return hr;
+}
+
+void ShaderCompiler::CreateCompiler()
+{
+	// Only created on a cache miss.
+	if (m_compiler)
+		return;
+	DxcCreateInstance(CLSID_DxcLibrary, IID_PPV_ARGS(&m_library));
+	DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&m_compiler));
+}
\ No newline at end of file
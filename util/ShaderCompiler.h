@@ -0,0 +1,48 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <d3d12.h>
+
+#include <wrl.h>
+#include <string>
+#include <vector>
+#include "ShaderCache.h"
+
+struct IDxcLibrary;
+struct IDxcCompiler;
+
+struct ShaderDefine {
+	std::wstring name;
+	std::wstring value;
+};
+
+// Compiles HLSL files with DXC. Outputs are cached on disk, so an unchanged shader is loaded
+// without invoking the compiler on the next start.
+class ShaderCompiler {
+public:
+	template<class T>
+	using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+	// Outputs are cached in cacheDirectory, relative to the working directory.
+	explicit ShaderCompiler(const std::wstring& cacheDirectory = L"ShaderCache");
+	~ShaderCompiler();
+
+	// dependencies receives the files included by the shader when given.
+	HRESULT CompileFromFile(
+		const std::wstring& fileName, const std::wstring& entryPoint, const std::wstring& profile,
+		const std::vector<ShaderDefine>& defines, ComPtr<ID3DBlob>& shaderBlob, ComPtr<ID3DBlob>& errorBlob,
+		std::vector<ShaderDependency>* dependencies = nullptr);
+
+	// Identifies the DXC binary and the flags given to it. Outputs of different fingerprints may differ.
+	static uint64_t GetFingerprint();
+
+	ShaderCache& GetCache() { return m_cache; }
+
+private:
+	void CreateCompiler();
+
+	ShaderCache m_cache;
+	ComPtr<IDxcLibrary> m_library;
+	ComPtr<IDxcCompiler> m_compiler;
+};
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "ShaderIncludeHandler.h"
+#include <fstream>
+
+#if _MSC_VER > 1922
+#define _SILENCE_EXPERIMENTAL_FILESYSTEM_DEPRECATION_WARNING
+#endif
+#include <experimental/filesystem>
+
+ShaderIncludeCache& ShaderIncludeCache::Get()
+{
+	static ShaderIncludeCache cache;
+	return cache;
+}
+
+std::shared_ptr<const ShaderIncludeCache::File> ShaderIncludeCache::Load(const std::wstring& path)
+{
+	using namespace std::experimental::filesystem;
+
+	std::error_code ec;
+	const auto writeTime = last_write_time(path, ec);
+	if (ec)
+		return nullptr;
+	const int64_t time = writeTime.time_since_epoch().count();
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_files.find(path);
+		if (it != m_files.end() && it->second->writeTime == time)
+			return it->second;
+	}
+
+	// Read outside of the lock. Another thread may read the same file, which is harmless.
+	std::ifstream infile(path, std::ios::binary);
+	if (!infile)
+		return nullptr;
+	auto file = std::make_shared<File>();
+	file->writeTime = time;
+	file->data.resize(size_t(infile.seekg(0, infile.end).tellg()));
+	infile.seekg(0, infile.beg).read(file->data.data(), file->data.size());
+	file->hash = ShaderHasher().Add(file->data.data(), file->data.size()).Get();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_files[path] = file;
+	return file;
+}
+
+bool ShaderIncludeCache::IsUpToDate(const std::vector<ShaderDependency>& dependencies)
+{
+	for (const auto& dependency : dependencies)
+	{
+		auto file = Load(dependency.path);
+		if (!file || file->hash != dependency.hash)
+			return false;
+	}
+	return true;
+}
+
+HRESULT STDMETHODCALLTYPE ShaderIncludeHandler::LoadSource(LPCWSTR fileName, IDxcBlob** includeSource)
+{
+	auto file = ShaderIncludeCache::Get().Load(fileName);
+	if (!file)
+	{
+		*includeSource = nullptr;
+		return E_FAIL;
+	}
+
+	// Record once even if it is included from several files.
+	bool recorded = false;
+	for (const auto& dependency : m_dependencies)
+		recorded |= (dependency.path == fileName);
+	if (!recorded)
+		m_dependencies.push_back({ fileName, file->hash });
+
+	IDxcBlobEncoding* blob = nullptr;
+	HRESULT hr = m_library->CreateBlobWithEncodingOnHeapCopy(file->data.data(), UINT32(file->data.size()), CP_UTF8, &blob);
+	*includeSource = blob;
+	return hr;
+}
\ No newline at end of file
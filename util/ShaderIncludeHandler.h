@@ -0,0 +1,75 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <d3d12.h>
+
+#include <wrl.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <dxcapi.h>
+#include "ShaderCache.h"
+
+// Process wide in memory cache of include files shared by every compiler.
+// A file is read and hashed again only when its timestamp has changed.
+class ShaderIncludeCache {
+public:
+	struct File {
+		int64_t writeTime = 0;
+		uint64_t hash = 0;
+		std::vector<char> data;
+	};
+
+	static ShaderIncludeCache& Get();
+
+	// Return nullptr when the file doesn't exist.
+	std::shared_ptr<const File> Load(const std::wstring& path);
+	// Whether every dependency still has the recorded hash.
+	bool IsUpToDate(const std::vector<ShaderDependency>& dependencies);
+
+private:
+	std::mutex m_mutex;
+	std::unordered_map<std::wstring, std::shared_ptr<const File>> m_files;
+};
+
+// Include handler given to DXC. It serves include files from ShaderIncludeCache
+// and records every file included while compiling, directly or transitively.
+class ShaderIncludeHandler : public IDxcIncludeHandler {
+public:
+	explicit ShaderIncludeHandler(IDxcLibrary* library) : m_refCount(1), m_library(library) {}
+	virtual ~ShaderIncludeHandler() {}
+
+	HRESULT STDMETHODCALLTYPE LoadSource(LPCWSTR fileName, IDxcBlob** includeSource) override;
+
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** object) override
+	{
+		if (riid == __uuidof(IUnknown) || riid == __uuidof(IDxcIncludeHandler))
+		{
+			*object = static_cast<IDxcIncludeHandler*>(this);
+			AddRef();
+			return S_OK;
+		}
+		*object = nullptr;
+		return E_NOINTERFACE;
+	}
+	ULONG STDMETHODCALLTYPE AddRef() override { return ++m_refCount; }
+	ULONG STDMETHODCALLTYPE Release() override
+	{
+		const ULONG count = --m_refCount;
+		if (count == 0)
+			delete this;
+		return count;
+	}
+
+	const std::vector<ShaderDependency>& GetDependencies() const { return m_dependencies; }
+
+private:
+	std::atomic<ULONG> m_refCount;
+	Microsoft::WRL::ComPtr<IDxcLibrary> m_library;
+	std::vector<ShaderDependency> m_dependencies;
+};
\ No newline at end of file
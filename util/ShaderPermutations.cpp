@@ -0,0 +1,141 @@
+#include "ShaderPermutations.h"
+#include "ShaderCompileService.h"
+#include "util.h"
+#include <stdexcept>
+
+ShaderPermutations::ShaderPermutations(
+	ShaderCompileService* service, const std::wstring& fileName, const std::wstring& entryPoint,
+	const std::wstring& profile, const std::vector<std::wstring>& features)
+	: m_service(service), m_fileName(fileName), m_entryPoint(entryPoint), m_profile(profile), m_features(features)
+{
+	if (m_features.size() > MaxFeatures)
+		throw std::runtime_error("Too many shader features.");
+}
+
+uint32_t ShaderPermutations::GetFeatureBit(const std::wstring& feature) const
+{
+	for (size_t i = 0; i < m_features.size(); i++)
+	{
+		if (m_features[i] == feature)
+			return 1u << i;
+	}
+	throw std::runtime_error("Undeclared shader feature.");
+}
+
+uint32_t ShaderPermutations::GetKey(const std::vector<std::wstring>& features) const
+{
+	uint32_t key = 0;
+	for (const auto& feature : features)
+		key |= GetFeatureBit(feature);
+	return key;
+}
+
+ID3DBlob* ShaderPermutations::Get(uint32_t key)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_variants.find(key);
+		if (it != m_variants.end())
+			return it->second;
+	}
+
+	// Threads missing the same key both compile it, and Register() keeps the first.
+	auto result = m_service->Submit(MakeJob(key)).get();
+	if (FAILED(result.hr))
+	{
+		if (result.error)
+			Util::Log("%s\n", static_cast<const char*>(result.error->GetBufferPointer()));
+		throw std::runtime_error("Failed CompileFromFile");
+	}
+	return Register(key, result.shader.Get());
+}
+
+D3D12_SHADER_BYTECODE ShaderPermutations::GetBytecode(uint32_t key)
+{
+	auto blob = Get(key);
+	return { blob->GetBufferPointer(), blob->GetBufferSize() };
+}
+
+void ShaderPermutations::Precompile(const std::vector<uint32_t>& keys)
+{
+	std::vector<uint32_t> pending;
+	std::vector<ShaderCompileJob> jobs;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (auto key : keys)
+		{
+			if (m_variants.count(key) == 0)
+				pending.push_back(key);
+		}
+	}
+	for (auto key : pending)
+		jobs.push_back(MakeJob(key));
+
+	auto futures = m_service->Submit(jobs);
+	for (size_t i = 0; i < futures.size(); i++)
+	{
+		auto result = futures[i].get();
+		if (FAILED(result.hr))
+		{
+			if (result.error)
+				Util::Log("%s\n", static_cast<const char*>(result.error->GetBufferPointer()));
+			throw std::runtime_error("Failed CompileFromFile");
+		}
+		Register(pending[i], result.shader.Get());
+	}
+}
+
+ShaderPermutationStats ShaderPermutations::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	ShaderPermutationStats stats;
+	stats.features = UINT(m_features.size());
+	stats.variants = UINT(m_variants.size());
+	stats.uniqueBlobs = UINT(m_blobs.size());
+	stats.bytes = m_bytes;
+	return stats;
+}
+
+void ShaderPermutations::ReportStats() const
+{
+	const auto stats = GetStats();
+	Util::Log("%ls(%ls): %u features, %u variants, %u unique blobs, %zu bytes\n",
+		m_fileName.c_str(), m_entryPoint.c_str(), stats.features, stats.variants, stats.uniqueBlobs, stats.bytes);
+}
+
+ShaderCompileJob ShaderPermutations::MakeJob(uint32_t key) const
+{
+	if (key >> m_features.size())
+		throw std::runtime_error("Invalid shader permutation key.");
+
+	ShaderCompileJob job;
+	job.fileName = m_fileName;
+	job.entryPoint = m_entryPoint;
+	job.profile = m_profile;
+	for (size_t i = 0; i < m_features.size(); i++)
+	{
+		if (key & (1u << i))
+			job.defines.push_back({ m_features[i], L"1" });
+	}
+	return job;
+}
+
+ID3DBlob* ShaderPermutations::Register(uint32_t key, ID3DBlob* blob)
+{
+	const auto hash = ShaderHasher().Add(blob->GetBufferPointer(), blob->GetBufferSize()).Get();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	// Another thread may have compiled the same key meanwhile.
+	auto variant = m_variants.find(key);
+	if (variant != m_variants.end())
+		return variant->second;
+
+	auto it = m_blobs.find(hash);
+	if (it == m_blobs.end())
+	{
+		it = m_blobs.emplace(hash, blob).first;
+		m_bytes += blob->GetBufferSize();
+	}
+	m_variants[key] = it->second.Get();
+	return it->second.Get();
+}
\ No newline at end of file
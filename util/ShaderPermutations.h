@@ -0,0 +1,69 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <d3d12.h>
+
+#include <wrl.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ShaderCompileService.h"
+
+struct ShaderPermutationStats {
+	UINT features = 0;
+	// Number of keys compiled so far, and the distinct DXIL blobs they resolved to.
+	UINT variants = 0;
+	UINT uniqueBlobs = 0;
+	size_t bytes = 0;
+};
+
+// Variants of one shader entry point selected by a bitmask of feature keys.
+// Bit i of the key defines features[i] as 1 (e.g. HAS_NORMAL_MAP), so a material picks
+// a specialized shader without branching at runtime. Variants are compiled on first use
+// or ahead of time with Precompile(), and keys producing the same DXIL share one blob.
+// Every compilation runs on the workers of the compile service, which own their DXC instances,
+// so Get() may be called from several threads.
+class ShaderPermutations {
+public:
+	template<class T>
+	using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+	static const UINT MaxFeatures = 16;
+
+	ShaderPermutations(
+		ShaderCompileService* service, const std::wstring& fileName, const std::wstring& entryPoint,
+		const std::wstring& profile, const std::vector<std::wstring>& features);
+
+	// Bit of the feature in the key. Throws for an undeclared feature.
+	uint32_t GetFeatureBit(const std::wstring& feature) const;
+	uint32_t GetKey(const std::vector<std::wstring>& features) const;
+
+	// Compile the variant when it doesn't exist yet. Throws when the compilation fails.
+	ID3DBlob* Get(uint32_t key);
+	D3D12_SHADER_BYTECODE GetBytecode(uint32_t key);
+
+	// Compile the given variants in parallel. Variants which already exist are skipped.
+	void Precompile(const std::vector<uint32_t>& keys);
+
+	ShaderPermutationStats GetStats() const;
+	void ReportStats() const;
+
+private:
+	ShaderCompileJob MakeJob(uint32_t key) const;
+	ID3DBlob* Register(uint32_t key, ID3DBlob* blob);
+
+	ShaderCompileService* m_service;
+	std::wstring m_fileName;
+	std::wstring m_entryPoint;
+	std::wstring m_profile;
+	std::vector<std::wstring> m_features;
+
+	mutable std::mutex m_mutex;
+	// Key to the shared blob, and DXIL hash to the blob owning the bytes.
+	std::unordered_map<uint32_t, ID3DBlob*> m_variants;
+	std::unordered_map<uint64_t, ComPtr<ID3DBlob>> m_blobs;
+	size_t m_bytes = 0;
+};
\ No newline at end of file
@@ -0,0 +1,473 @@
+#include "ShaderReflector.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <tuple>
+
+// For DirectX Shader Compiler.
+#include <dxcapi.h>
+#include <d3d12shader.h>
+#pragma comment(lib, "dxcompiler.lib")
+
+namespace {
+	// Bumped when the cached layout format or the packing rules change.
+	const uint32_t LayoutVersion = 2;
+	const uint32_t DxilPartKind = 'D' | ('X' << 8) | ('I' << 16) | ('L' << 24);
+
+	class LayoutWriter {
+	public:
+		explicit LayoutWriter(std::vector<char>& data) : m_data(data) {}
+		void Write(uint32_t value) { Append(&value, sizeof(value)); }
+		void Write(const std::string& str)
+		{
+			Write(uint32_t(str.size()));
+			Append(str.data(), str.size());
+		}
+	private:
+		void Append(const void* p, size_t size)
+		{
+			m_data.insert(m_data.end(), static_cast<const char*>(p), static_cast<const char*>(p) + size);
+		}
+		std::vector<char>& m_data;
+	};
+
+	class LayoutReader {
+	public:
+		LayoutReader(const void* data, size_t size) : m_data(static_cast<const char*>(data)), m_size(size) {}
+		uint32_t ReadUint()
+		{
+			uint32_t value = 0;
+			Copy(&value, sizeof(value));
+			return value;
+		}
+		std::string ReadString()
+		{
+			std::string str(ReadUint(), '\0');
+			Copy(&str[0], str.size());
+			return str;
+		}
+		bool IsValid() const { return m_valid; }
+	private:
+		void Copy(void* dest, size_t size)
+		{
+			if (m_offset + size > m_size)
+			{
+				m_valid = false;
+				return;
+			}
+			memcpy(dest, m_data + m_offset, size);
+			m_offset += size;
+		}
+		const char* m_data;
+		size_t m_size;
+		size_t m_offset = 0;
+		bool m_valid = true;
+	};
+
+	D3D12_SHADER_VISIBILITY GetVisibility(UINT version)
+	{
+		switch (D3D12_SHVER_GET_TYPE(version))
+		{
+		case D3D12_SHVER_VERTEX_SHADER: return D3D12_SHADER_VISIBILITY_VERTEX;
+		case D3D12_SHVER_PIXEL_SHADER: return D3D12_SHADER_VISIBILITY_PIXEL;
+		case D3D12_SHVER_GEOMETRY_SHADER: return D3D12_SHADER_VISIBILITY_GEOMETRY;
+		case D3D12_SHVER_HULL_SHADER: return D3D12_SHADER_VISIBILITY_HULL;
+		case D3D12_SHVER_DOMAIN_SHADER: return D3D12_SHADER_VISIBILITY_DOMAIN;
+		default: return D3D12_SHADER_VISIBILITY_ALL;
+		}
+	}
+
+	D3D12_ROOT_SIGNATURE_FLAGS GetDenyFlag(D3D12_SHADER_VISIBILITY visibility)
+	{
+		switch (visibility)
+		{
+		case D3D12_SHADER_VISIBILITY_VERTEX: return D3D12_ROOT_SIGNATURE_FLAG_DENY_VERTEX_SHADER_ROOT_ACCESS;
+		case D3D12_SHADER_VISIBILITY_PIXEL: return D3D12_ROOT_SIGNATURE_FLAG_DENY_PIXEL_SHADER_ROOT_ACCESS;
+		case D3D12_SHADER_VISIBILITY_GEOMETRY: return D3D12_ROOT_SIGNATURE_FLAG_DENY_GEOMETRY_SHADER_ROOT_ACCESS;
+		case D3D12_SHADER_VISIBILITY_HULL: return D3D12_ROOT_SIGNATURE_FLAG_DENY_HULL_SHADER_ROOT_ACCESS;
+		case D3D12_SHADER_VISIBILITY_DOMAIN: return D3D12_ROOT_SIGNATURE_FLAG_DENY_DOMAIN_SHADER_ROOT_ACCESS;
+		default: return D3D12_ROOT_SIGNATURE_FLAG_NONE;
+		}
+	}
+
+	D3D12_DESCRIPTOR_RANGE_TYPE GetRangeType(D3D_SHADER_INPUT_TYPE type)
+	{
+		switch (type)
+		{
+		case D3D_SIT_CBUFFER:
+			return D3D12_DESCRIPTOR_RANGE_TYPE_CBV;
+		case D3D_SIT_SAMPLER:
+			return D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER;
+		case D3D_SIT_UAV_RWTYPED:
+		case D3D_SIT_UAV_RWSTRUCTURED:
+		case D3D_SIT_UAV_RWBYTEADDRESS:
+		case D3D_SIT_UAV_APPEND_STRUCTURED:
+		case D3D_SIT_UAV_CONSUME_STRUCTURED:
+		case D3D_SIT_UAV_RWSTRUCTURED_WITH_COUNTER:
+			return D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
+		default:
+			return D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+		}
+	}
+
+	DXGI_FORMAT GetInputFormat(D3D_REGISTER_COMPONENT_TYPE type, BYTE mask)
+	{
+		static const DXGI_FORMAT floatFormats[] = {
+			DXGI_FORMAT_R32_FLOAT, DXGI_FORMAT_R32G32_FLOAT, DXGI_FORMAT_R32G32B32_FLOAT, DXGI_FORMAT_R32G32B32A32_FLOAT };
+		static const DXGI_FORMAT uintFormats[] = {
+			DXGI_FORMAT_R32_UINT, DXGI_FORMAT_R32G32_UINT, DXGI_FORMAT_R32G32B32_UINT, DXGI_FORMAT_R32G32B32A32_UINT };
+		static const DXGI_FORMAT sintFormats[] = {
+			DXGI_FORMAT_R32_SINT, DXGI_FORMAT_R32G32_SINT, DXGI_FORMAT_R32G32B32_SINT, DXGI_FORMAT_R32G32B32A32_SINT };
+
+		// The components are used from x, so the highest bit gives the count.
+		int components = (mask & 8) ? 4 : (mask & 4) ? 3 : (mask & 2) ? 2 : 1;
+		switch (type)
+		{
+		case D3D_REGISTER_COMPONENT_UINT32: return uintFormats[components - 1];
+		case D3D_REGISTER_COMPONENT_SINT32: return sintFormats[components - 1];
+		default: return floatFormats[components - 1];
+		}
+	}
+
+	bool IsRootConstantBuffer(const ShaderBinding& binding)
+	{
+		return binding.type == D3D12_DESCRIPTOR_RANGE_TYPE_CBV && binding.count == 1;
+	}
+}
+
+int ShaderLayout::FindParameter(const std::string& name) const
+{
+	for (size_t i = 0; i < parameters.size(); i++)
+	{
+		for (const auto& binding : parameters[i].bindings)
+		{
+			if (binding.name == name)
+				return int(i);
+		}
+	}
+	return -1;
+}
+
+UINT ShaderLayout::GetParameter(const std::string& name) const
+{
+	const int index = FindParameter(name);
+	if (index < 0)
+		throw std::runtime_error("Unknown shader binding: " + name);
+	return UINT(index);
+}
+
+UINT ShaderLayout::GetTableOffset(const std::string& name) const
+{
+	for (const auto& parameter : parameters)
+	{
+		UINT offset = 0;
+		for (const auto& binding : parameter.bindings)
+		{
+			if (binding.name == name)
+				return offset;
+			offset += binding.count;
+		}
+	}
+	throw std::runtime_error("Unknown shader binding.");
+}
+
+HRESULT ShaderLayout::SerializeRootSignature(ComPtr<ID3DBlob>& signature) const
+{
+	std::vector<std::vector<CD3DX12_DESCRIPTOR_RANGE>> ranges(parameters.size());
+	std::vector<CD3DX12_ROOT_PARAMETER> rootParams(parameters.size());
+	for (size_t i = 0; i < parameters.size(); i++)
+	{
+		const auto& parameter = parameters[i];
+		const auto& first = parameter.bindings[0];
+		switch (parameter.kind)
+		{
+		case RootParameterKind::Constants:
+			rootParams[i].InitAsConstants(first.size / 4, first.shaderRegister, first.space, parameter.visibility);
+			break;
+		case RootParameterKind::ConstantBuffer:
+			rootParams[i].InitAsConstantBufferView(first.shaderRegister, first.space, parameter.visibility);
+			break;
+		case RootParameterKind::Table:
+			for (const auto& binding : parameter.bindings)
+			{
+				ranges[i].emplace_back();
+				ranges[i].back().Init(binding.type, binding.count, binding.shaderRegister, binding.space);
+			}
+			rootParams[i].InitAsDescriptorTable(UINT(ranges[i].size()), ranges[i].data(), parameter.visibility);
+			break;
+		}
+	}
+
+	CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc{};
+	rootSigDesc.Init(UINT(rootParams.size()), rootParams.data(), 0, nullptr, flags);
+	ComPtr<ID3DBlob> errBlob;
+	return D3D12SerializeRootSignature(&rootSigDesc, D3D_ROOT_SIGNATURE_VERSION_1_0, &signature, &errBlob);
+}
+
+HRESULT ShaderLayout::CreateRootSignature(ID3D12Device* device, ComPtr<ID3D12RootSignature>& rootSignature) const
+{
+	ComPtr<ID3DBlob> signature;
+	HRESULT hr = SerializeRootSignature(signature);
+	if (FAILED(hr))
+		return hr;
+	return device->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&rootSignature));
+}
+
+std::vector<D3D12_INPUT_ELEMENT_DESC> ShaderLayout::GetInputLayout(UINT inputSlot, UINT instanceSlot) const
+{
+	const size_t prefixLength = strlen(InstanceSemanticPrefix);
+	std::vector<D3D12_INPUT_ELEMENT_DESC> elements;
+	for (const auto& element : inputElements)
+	{
+		// Aligned offsets are counted per slot, so each stream is packed in the order of VS inputs.
+		if (element.semantic.compare(0, prefixLength, InstanceSemanticPrefix) == 0)
+		{
+			elements.push_back({
+				element.semantic.c_str(), element.index, element.format, instanceSlot,
+				D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+			continue;
+		}
+		elements.push_back({
+			element.semantic.c_str(), element.index, element.format, inputSlot,
+			D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 });
+	}
+	return elements;
+}
+
+void ShaderLayout::Write(std::vector<char>& data) const
+{
+	LayoutWriter writer(data);
+	writer.Write(LayoutVersion);
+	writer.Write(uint32_t(flags));
+	writer.Write(uint32_t(parameters.size()));
+	for (const auto& parameter : parameters)
+	{
+		writer.Write(uint32_t(parameter.kind));
+		writer.Write(uint32_t(parameter.visibility));
+		writer.Write(uint32_t(parameter.bindings.size()));
+		for (const auto& binding : parameter.bindings)
+		{
+			writer.Write(binding.name);
+			writer.Write(uint32_t(binding.type));
+			writer.Write(binding.shaderRegister);
+			writer.Write(binding.space);
+			writer.Write(binding.count);
+			writer.Write(binding.size);
+			writer.Write(uint32_t(binding.visibility));
+		}
+	}
+	writer.Write(uint32_t(inputElements.size()));
+	for (const auto& element : inputElements)
+	{
+		writer.Write(element.semantic);
+		writer.Write(element.index);
+		writer.Write(uint32_t(element.format));
+	}
+}
+
+bool ShaderLayout::Read(const void* data, size_t size)
+{
+	LayoutReader reader(data, size);
+	if (reader.ReadUint() != LayoutVersion)
+		return false;
+	flags = D3D12_ROOT_SIGNATURE_FLAGS(reader.ReadUint());
+	parameters.resize(reader.ReadUint());
+	for (auto& parameter : parameters)
+	{
+		if (!reader.IsValid())
+			return false;
+		parameter.kind = RootParameterKind(reader.ReadUint());
+		parameter.visibility = D3D12_SHADER_VISIBILITY(reader.ReadUint());
+		parameter.bindings.resize(reader.ReadUint());
+		for (auto& binding : parameter.bindings)
+		{
+			if (!reader.IsValid())
+				return false;
+			binding.name = reader.ReadString();
+			binding.type = D3D12_DESCRIPTOR_RANGE_TYPE(reader.ReadUint());
+			binding.shaderRegister = reader.ReadUint();
+			binding.space = reader.ReadUint();
+			binding.count = reader.ReadUint();
+			binding.size = reader.ReadUint();
+			binding.visibility = D3D12_SHADER_VISIBILITY(reader.ReadUint());
+		}
+	}
+	inputElements.resize(reader.ReadUint());
+	for (auto& element : inputElements)
+	{
+		if (!reader.IsValid())
+			return false;
+		element.semantic = reader.ReadString();
+		element.index = reader.ReadUint();
+		element.format = DXGI_FORMAT(reader.ReadUint());
+	}
+	return reader.IsValid();
+}
+
+ShaderReflector::ShaderReflector()
+{
+}
+
+ShaderReflector::~ShaderReflector()
+{
+}
+
+void ShaderReflector::Reflect(const std::vector<ID3DBlob*>& shaders, ShaderLayout& layout)
+{
+	ShaderHasher hasher;
+	hasher.Add(LayoutVersion).Add(MaxRootConstants);
+	for (auto shader : shaders)
+		hasher.Add(shader->GetBufferPointer(), shader->GetBufferSize());
+	const auto key = hasher.Get();
+
+	ComPtr<ID3DBlob> cached;
+	if (m_cache.Load(key, cached, L".layout") && layout.Read(cached->GetBufferPointer(), cached->GetBufferSize()))
+		return;
+
+	if (!m_reflection)
+	{
+		HRESULT hr = DxcCreateInstance(CLSID_DxcLibrary, IID_PPV_ARGS(&m_library));
+		if (SUCCEEDED(hr))
+			hr = DxcCreateInstance(CLSID_DxcContainerReflection, IID_PPV_ARGS(&m_reflection));
+		if (FAILED(hr))
+			throw std::runtime_error("Failed DxcCreateInstance");
+	}
+
+	layout = ShaderLayout();
+	layout.flags =
+		D3D12_ROOT_SIGNATURE_FLAG_DENY_VERTEX_SHADER_ROOT_ACCESS |
+		D3D12_ROOT_SIGNATURE_FLAG_DENY_HULL_SHADER_ROOT_ACCESS |
+		D3D12_ROOT_SIGNATURE_FLAG_DENY_DOMAIN_SHADER_ROOT_ACCESS |
+		D3D12_ROOT_SIGNATURE_FLAG_DENY_GEOMETRY_SHADER_ROOT_ACCESS |
+		D3D12_ROOT_SIGNATURE_FLAG_DENY_PIXEL_SHADER_ROOT_ACCESS;
+	std::vector<ShaderBinding> bindings;
+	for (auto shader : shaders)
+		ReflectShader(shader, bindings, layout);
+	BuildParameters(bindings, layout);
+	if (!layout.inputElements.empty())
+		layout.flags |= D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
+
+	std::vector<char> data;
+	layout.Write(data);
+	ComPtr<ID3DBlob> blob;
+	blob.Attach(new ShaderBlob(std::move(data)));
+	m_cache.Store(key, blob.Get(), L".layout");
+}
+
+void ShaderReflector::ReflectShader(ID3DBlob* shader, std::vector<ShaderBinding>& bindings, ShaderLayout& layout)
+{
+	ComPtr<IDxcBlobEncoding> container;
+	ComPtr<ID3D12ShaderReflection> reflection;
+	UINT32 partIndex = 0;
+	HRESULT hr = m_library->CreateBlobWithEncodingFromPinned(shader->GetBufferPointer(), UINT32(shader->GetBufferSize()), 0, &container);
+	if (SUCCEEDED(hr))
+		hr = m_reflection->Load(container.Get());
+	if (SUCCEEDED(hr))
+		hr = m_reflection->FindFirstPartKind(DxilPartKind, &partIndex);
+	if (SUCCEEDED(hr))
+		hr = m_reflection->GetPartReflection(partIndex, IID_PPV_ARGS(&reflection));
+	if (FAILED(hr))
+		throw std::runtime_error("Failed GetPartReflection");
+
+	D3D12_SHADER_DESC shaderDesc;
+	reflection->GetDesc(&shaderDesc);
+	const auto visibility = GetVisibility(shaderDesc.Version);
+	layout.flags &= ~GetDenyFlag(visibility);
+
+	for (UINT i = 0; i < shaderDesc.BoundResources; i++)
+	{
+		D3D12_SHADER_INPUT_BIND_DESC bindDesc;
+		reflection->GetResourceBindingDesc(i, &bindDesc);
+
+		ShaderBinding binding;
+		binding.name = bindDesc.Name;
+		binding.type = GetRangeType(bindDesc.Type);
+		binding.shaderRegister = bindDesc.BindPoint;
+		binding.space = bindDesc.Space;
+		binding.count = bindDesc.BindCount == 0 ? UINT_MAX : bindDesc.BindCount;
+		binding.size = 0;
+		binding.visibility = visibility;
+		if (binding.type == D3D12_DESCRIPTOR_RANGE_TYPE_CBV)
+		{
+			D3D12_SHADER_BUFFER_DESC bufferDesc;
+			reflection->GetConstantBufferByName(bindDesc.Name)->GetDesc(&bufferDesc);
+			binding.size = bufferDesc.Size;
+		}
+
+		// A resource used by several stages is bound once and visible to all of them.
+		auto it = std::find_if(bindings.begin(), bindings.end(), [&binding](const ShaderBinding& b) {
+			return b.type == binding.type && b.shaderRegister == binding.shaderRegister && b.space == binding.space;
+		});
+		if (it == bindings.end())
+			bindings.push_back(binding);
+		else if (it->visibility != visibility)
+			it->visibility = D3D12_SHADER_VISIBILITY_ALL;
+	}
+
+	if (visibility == D3D12_SHADER_VISIBILITY_VERTEX)
+	{
+		for (UINT i = 0; i < shaderDesc.InputParameters; i++)
+		{
+			D3D12_SIGNATURE_PARAMETER_DESC paramDesc;
+			reflection->GetInputParameterDesc(i, &paramDesc);
+			// System values such as SV_VertexID are not fed by the input assembler.
+			if (paramDesc.SystemValueType != D3D_NAME_UNDEFINED)
+				continue;
+			layout.inputElements.push_back({
+				paramDesc.SemanticName, paramDesc.SemanticIndex, GetInputFormat(paramDesc.ComponentType, paramDesc.Mask) });
+		}
+	}
+}
+
+void ShaderReflector::BuildParameters(std::vector<ShaderBinding>& bindings, ShaderLayout& layout)
+{
+	// Unbounded arrays go after the other bindings of their visibility. A range following
+	// an unbounded one can't be placed by OFFSET_APPEND, so each of them ends its table.
+	std::sort(bindings.begin(), bindings.end(), [](const ShaderBinding& a, const ShaderBinding& b) {
+		return std::make_tuple(a.visibility, a.count == UINT_MAX, a.type, a.space, a.shaderRegister) <
+			std::make_tuple(b.visibility, b.count == UINT_MAX, b.type, b.space, b.shaderRegister);
+	});
+
+	// Everything else goes to one table per visibility, and samplers to their own table since they live in another heap.
+	std::vector<ShaderRootParameter> tables, samplerTables;
+	std::vector<ShaderBinding> constantBuffers;
+	for (const auto& binding : bindings)
+	{
+		if (IsRootConstantBuffer(binding))
+		{
+			constantBuffers.push_back(binding);
+			continue;
+		}
+		auto& group = binding.type == D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER ? samplerTables : tables;
+		if (group.empty() || group.back().visibility != binding.visibility || group.back().bindings.back().count == UINT_MAX)
+			group.push_back({ RootParameterKind::Table, binding.visibility, {} });
+		group.back().bindings.push_back(binding);
+	}
+
+	// A table costs 1 DWORD, a root descriptor 2 and root constants their size.
+	int budget = int(MaxRootSignatureSize) - int(tables.size() + samplerTables.size()) - 2 * int(constantBuffers.size());
+	if (budget < 0)
+		throw std::runtime_error("Root signature is too large.");
+
+	// Smaller buffers are promoted first, as they give the most parameters for the space.
+	std::stable_sort(constantBuffers.begin(), constantBuffers.end(),
+		[](const ShaderBinding& a, const ShaderBinding& b) { return a.size < b.size; });
+	std::vector<ShaderRootParameter> constants, descriptors;
+	for (const auto& binding : constantBuffers)
+	{
+		const int dwords = int(binding.size / 4);
+		if (dwords <= int(MaxRootConstants) && dwords - 2 <= budget)
+		{
+			budget -= dwords - 2;
+			constants.push_back({ RootParameterKind::Constants, binding.visibility, { binding } });
+		}
+		else
+		{
+			descriptors.push_back({ RootParameterKind::ConstantBuffer, binding.visibility, { binding } });
+		}
+	}
+
+	layout.parameters.clear();
+	for (auto* group : { &constants, &descriptors, &tables, &samplerTables })
+		layout.parameters.insert(layout.parameters.end(), group->begin(), group->end());
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <d3d12.h>
+#include "d3dx12.h"
+
+#include <wrl.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ShaderCache.h"
+
+struct IDxcLibrary;
+struct IDxcContainerReflection;
+
+// A resource bound by the shaders.
+struct ShaderBinding {
+	std::string name;
+	D3D12_DESCRIPTOR_RANGE_TYPE type;
+	UINT shaderRegister;
+	UINT space;
+	UINT count;		// UINT_MAX for unbounded arrays.
+	UINT size;		// Bytes of a constant buffer.
+	D3D12_SHADER_VISIBILITY visibility;
+};
+
+enum class RootParameterKind : uint32_t {
+	Constants,		// Constant buffer in the root arguments.
+	ConstantBuffer,	// Root descriptor.
+	Table,
+};
+
+struct ShaderRootParameter {
+	RootParameterKind kind;
+	D3D12_SHADER_VISIBILITY visibility;
+	// One binding for constants and constant buffers, the ranges in order for tables.
+	std::vector<ShaderBinding> bindings;
+};
+
+struct ShaderInputElement {
+	std::string semantic;
+	UINT index;
+	DXGI_FORMAT format;
+};
+
+// Root signature and input layout of a pipeline derived from its shaders.
+class ShaderLayout {
+public:
+	template<class T>
+	using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+	// Root parameter index of a binding by its name in HLSL, or -1.
+	int FindParameter(const std::string& name) const;
+	// Same as FindParameter() for a binding the caller requires. Throws when the shaders don't have it.
+	UINT GetParameter(const std::string& name) const;
+	// Descriptor offset of a binding in its table.
+	UINT GetTableOffset(const std::string& name) const;
+
+	HRESULT SerializeRootSignature(ComPtr<ID3DBlob>& signature) const;
+	HRESULT CreateRootSignature(ID3D12Device* device, ComPtr<ID3D12RootSignature>& rootSignature) const;
+	// Elements are appended in the order of VS inputs. The names point into this layout.
+	// Inputs whose semantic starts with InstanceSemanticPrefix are read per instance from instanceSlot.
+	std::vector<D3D12_INPUT_ELEMENT_DESC> GetInputLayout(UINT inputSlot = 0, UINT instanceSlot = 1) const;
+
+	static constexpr const char* InstanceSemanticPrefix = "INSTANCE_";
+
+	void Write(std::vector<char>& data) const;
+	bool Read(const void* data, size_t size);
+
+	std::vector<ShaderRootParameter> parameters;
+	std::vector<ShaderInputElement> inputElements;
+	D3D12_ROOT_SIGNATURE_FLAGS flags = D3D12_ROOT_SIGNATURE_FLAG_NONE;
+};
+
+// Builds ShaderLayout from DXC reflection of compiled shaders.
+// Small constant buffers become root constants and the others root descriptors while
+// the root signature has space, so that draws set fewer descriptor tables.
+// Results are cached next to the DXIL in the shader cache.
+class ShaderReflector {
+public:
+	template<class T>
+	using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+	// Constant buffers up to this size in DWORDs are passed as root constants.
+	static const UINT MaxRootConstants = 16;
+	// Size limit of a root signature in DWORDs.
+	static const UINT MaxRootSignatureSize = 64;
+
+	ShaderReflector();
+	~ShaderReflector();
+
+	// Reflect the shaders of a pipeline. Throws when a blob has no reflection.
+	void Reflect(const std::vector<ID3DBlob*>& shaders, ShaderLayout& layout);
+
+private:
+	void ReflectShader(ID3DBlob* shader, std::vector<ShaderBinding>& bindings, ShaderLayout& layout);
+	static void BuildParameters(std::vector<ShaderBinding>& bindings, ShaderLayout& layout);
+
+	ShaderCache m_cache;
+	ComPtr<IDxcLibrary> m_library;
+	ComPtr<IDxcContainerReflection> m_reflection;
+};
\ No newline at end of file
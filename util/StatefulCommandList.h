@@ -0,0 +1,268 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <d3d12.h>
+
+#include <cstdint>
+#include <cstring>
+
+struct StatefulCommandListStats {
+	UINT issued = 0;	// State calls forwarded to the list.
+	UINT elided = 0;	// State calls dropped because the state was already bound.
+	UINT draws = 0;
+};
+
+// Front end of a command list which shadows the bound state and drops calls that would set it again.
+// List is ID3D12GraphicsCommandList, or any type with the same methods such as a recording fake.
+// Calls made directly on the list which change the state must be followed by Invalidate().
+template<class List = ID3D12GraphicsCommandList>
+class StatefulCommandList {
+public:
+	static const UINT MaxRootParameters = 64;
+	static const UINT MaxViewports = D3D12_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE;
+	static const UINT MaxVertexBuffers = D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT;
+	static const UINT MaxDescriptorHeaps = 2;
+
+	StatefulCommandList() { Invalidate(); }
+
+	// Start recording into a list which was just reset. The stats of the previous list are kept in GetLastStats().
+	void Begin(List* list)
+	{
+		m_list = list;
+		m_lastStats = m_stats;
+		m_stats = {};
+		Invalidate();
+	}
+
+	// Forget the shadowed state, so the next calls are all forwarded.
+	void Invalidate()
+	{
+		m_pipelineState = nullptr;
+		m_rootSignature = nullptr;
+		m_topology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+		m_viewportCount = m_scissorCount = m_heapCount = 0;
+		m_vertexBufferSlots = 0;
+		m_indexBufferValid = false;
+		InvalidateRootArguments();
+	}
+
+	List* Get() const { return m_list; }
+	List* operator->() const { return m_list; }
+
+	const StatefulCommandListStats& GetStats() const { return m_stats; }
+	const StatefulCommandListStats& GetLastStats() const { return m_lastStats; }
+
+	void SetPipelineState(ID3D12PipelineState* pipelineState)
+	{
+		if (Elide(m_pipelineState == pipelineState))
+			return;
+		m_pipelineState = pipelineState;
+		m_list->SetPipelineState(pipelineState);
+	}
+
+	void SetGraphicsRootSignature(ID3D12RootSignature* rootSignature)
+	{
+		if (Elide(m_rootSignature == rootSignature))
+			return;
+		m_rootSignature = rootSignature;
+		// Changing the root signature resets every root argument.
+		InvalidateRootArguments();
+		m_list->SetGraphicsRootSignature(rootSignature);
+	}
+
+	void RSSetViewports(UINT count, const D3D12_VIEWPORT* viewports)
+	{
+		if (Elide(count <= MaxViewports && count == m_viewportCount && memcmp(m_viewports, viewports, sizeof(D3D12_VIEWPORT) * count) == 0))
+			return;
+		m_viewportCount = count <= MaxViewports ? count : 0;
+		memcpy(m_viewports, viewports, sizeof(D3D12_VIEWPORT) * m_viewportCount);
+		m_list->RSSetViewports(count, viewports);
+	}
+
+	void RSSetScissorRects(UINT count, const D3D12_RECT* rects)
+	{
+		if (Elide(count <= MaxViewports && count == m_scissorCount && memcmp(m_scissorRects, rects, sizeof(D3D12_RECT) * count) == 0))
+			return;
+		m_scissorCount = count <= MaxViewports ? count : 0;
+		memcpy(m_scissorRects, rects, sizeof(D3D12_RECT) * m_scissorCount);
+		m_list->RSSetScissorRects(count, rects);
+	}
+
+	void SetDescriptorHeaps(UINT count, ID3D12DescriptorHeap* const* heaps)
+	{
+		if (Elide(count <= MaxDescriptorHeaps && count == m_heapCount && memcmp(m_heaps, heaps, sizeof(heaps[0]) * count) == 0))
+			return;
+		m_heapCount = count <= MaxDescriptorHeaps ? count : 0;
+		memcpy(m_heaps, heaps, sizeof(heaps[0]) * m_heapCount);
+		// Tables point into the previous heaps, so the same handle must be set again.
+		InvalidateRootTables();
+		m_list->SetDescriptorHeaps(count, heaps);
+	}
+
+	void IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology)
+	{
+		if (Elide(m_topology == topology))
+			return;
+		m_topology = topology;
+		m_list->IASetPrimitiveTopology(topology);
+	}
+
+	void IASetVertexBuffers(UINT startSlot, UINT count, const D3D12_VERTEX_BUFFER_VIEW* views)
+	{
+		bool bound = views != nullptr && startSlot + count <= MaxVertexBuffers;
+		for (UINT i = 0; bound && i < count; i++)
+		{
+			const UINT slot = startSlot + i;
+			bound = (m_vertexBufferSlots & (1u << slot)) &&
+				memcmp(&m_vertexBuffers[slot], &views[i], sizeof(D3D12_VERTEX_BUFFER_VIEW)) == 0;
+		}
+		if (Elide(bound))
+			return;
+		for (UINT i = 0; i < count && startSlot + i < MaxVertexBuffers; i++)
+		{
+			const UINT slot = startSlot + i;
+			if (views != nullptr)
+			{
+				m_vertexBuffers[slot] = views[i];
+				m_vertexBufferSlots |= 1u << slot;
+			}
+			else
+			{
+				m_vertexBufferSlots &= ~(1u << slot);
+			}
+		}
+		m_list->IASetVertexBuffers(startSlot, count, views);
+	}
+
+	void IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* view)
+	{
+		if (Elide(view != nullptr && m_indexBufferValid && memcmp(&m_indexBuffer, view, sizeof(*view)) == 0))
+			return;
+		m_indexBufferValid = view != nullptr;
+		if (view != nullptr)
+			m_indexBuffer = *view;
+		m_list->IASetIndexBuffer(view);
+	}
+
+	void SetGraphicsRootConstantBufferView(UINT index, D3D12_GPU_VIRTUAL_ADDRESS address)
+	{
+		if (Elide(SetRootArgument(index, RootArgumentKind::ConstantBuffer, address)))
+			return;
+		m_list->SetGraphicsRootConstantBufferView(index, address);
+	}
+
+	void SetGraphicsRootShaderResourceView(UINT index, D3D12_GPU_VIRTUAL_ADDRESS address)
+	{
+		if (Elide(SetRootArgument(index, RootArgumentKind::ShaderResource, address)))
+			return;
+		m_list->SetGraphicsRootShaderResourceView(index, address);
+	}
+
+	void SetGraphicsRootUnorderedAccessView(UINT index, D3D12_GPU_VIRTUAL_ADDRESS address)
+	{
+		if (Elide(SetRootArgument(index, RootArgumentKind::UnorderedAccess, address)))
+			return;
+		m_list->SetGraphicsRootUnorderedAccessView(index, address);
+	}
+
+	void SetGraphicsRootDescriptorTable(UINT index, D3D12_GPU_DESCRIPTOR_HANDLE table)
+	{
+		if (Elide(SetRootArgument(index, RootArgumentKind::Table, table.ptr)))
+			return;
+		m_list->SetGraphicsRootDescriptorTable(index, table);
+	}
+
+	// Root constants usually change per draw, so they are always forwarded.
+	void SetGraphicsRoot32BitConstants(UINT index, UINT count, const void* data, UINT offset)
+	{
+		m_stats.issued++;
+		m_list->SetGraphicsRoot32BitConstants(index, count, data, offset);
+	}
+
+	void DrawInstanced(UINT vertexCount, UINT instanceCount, UINT startVertex, UINT startInstance)
+	{
+		m_stats.draws++;
+		m_list->DrawInstanced(vertexCount, instanceCount, startVertex, startInstance);
+	}
+
+	void DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance)
+	{
+		m_stats.draws++;
+		m_list->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+	}
+
+	// The command signature may change vertex and index buffers and root arguments, which are forgotten.
+	void ExecuteIndirect(ID3D12CommandSignature* signature, UINT maxCommandCount, ID3D12Resource* argumentBuffer,
+		UINT64 argumentOffset, ID3D12Resource* countBuffer = nullptr, UINT64 countOffset = 0)
+	{
+		m_stats.draws++;
+		m_list->ExecuteIndirect(signature, maxCommandCount, argumentBuffer, argumentOffset, countBuffer, countOffset);
+		m_vertexBufferSlots = 0;
+		m_indexBufferValid = false;
+		InvalidateRootArguments();
+	}
+
+private:
+	enum class RootArgumentKind : uint32_t { None, ConstantBuffer, ShaderResource, UnorderedAccess, Table };
+
+	struct RootArgument {
+		RootArgumentKind kind;
+		uint64_t value;
+	};
+
+	bool Elide(bool alreadyBound)
+	{
+		if (alreadyBound)
+			m_stats.elided++;
+		else
+			m_stats.issued++;
+		return alreadyBound;
+	}
+
+	// Return true when the argument is already bound, otherwise record it.
+	bool SetRootArgument(UINT index, RootArgumentKind kind, uint64_t value)
+	{
+		if (index >= MaxRootParameters)
+			return false;
+		auto& argument = m_rootArguments[index];
+		if (argument.kind == kind && argument.value == value)
+			return true;
+		argument = { kind, value };
+		return false;
+	}
+
+	void InvalidateRootArguments()
+	{
+		for (auto& argument : m_rootArguments)
+			argument = { RootArgumentKind::None, 0 };
+	}
+
+	void InvalidateRootTables()
+	{
+		for (auto& argument : m_rootArguments)
+		{
+			if (argument.kind == RootArgumentKind::Table)
+				argument = { RootArgumentKind::None, 0 };
+		}
+	}
+
+	List* m_list = nullptr;
+	StatefulCommandListStats m_stats;
+	StatefulCommandListStats m_lastStats;
+
+	ID3D12PipelineState* m_pipelineState = nullptr;
+	ID3D12RootSignature* m_rootSignature = nullptr;
+	D3D12_PRIMITIVE_TOPOLOGY m_topology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+	UINT m_viewportCount = 0;
+	UINT m_scissorCount = 0;
+	D3D12_VIEWPORT m_viewports[MaxViewports];
+	D3D12_RECT m_scissorRects[MaxViewports];
+	UINT m_heapCount = 0;
+	ID3D12DescriptorHeap* m_heaps[MaxDescriptorHeaps];
+	uint32_t m_vertexBufferSlots = 0;
+	D3D12_VERTEX_BUFFER_VIEW m_vertexBuffers[MaxVertexBuffers];
+	bool m_indexBufferValid = false;
+	D3D12_INDEX_BUFFER_VIEW m_indexBuffer;
+	RootArgument m_rootArguments[MaxRootParameters];
+};
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "StaticBufferUploader.h"
+#include <stdexcept>
+
+void StaticBufferUploader::Initialize(ID3D12Device* device, ResourceHeapAllocator* heapAllocator, ResourceStateTracker* stateTracker,
+	CommandListPool* commandListPool, SignalFunc signal)
+{
+	m_device = device;
+	m_heapAllocator = heapAllocator;
+	m_stateTracker = stateTracker;
+	m_commandListPool = commandListPool;
+	m_signal = signal;
+}
+
+StaticBufferUploader::ComPtr<ID3D12Resource1> StaticBufferUploader::Enqueue(const void* data, UINT64 size, D3D12_RESOURCE_STATES finalState,
+	HeapAllocation& allocation)
+{
+	// Buffers always begin in COMMON state and are promoted to COPY_DEST by the copy.
+	auto buffer = m_heapAllocator->CreateResource(
+		CD3DX12_RESOURCE_DESC::Buffer(size),
+		D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_RESOURCE_STATE_COMMON,
+		nullptr,
+		allocation
+	);
+
+	// Keep a copy since the source is often on the caller's stack.
+	auto src = static_cast<const UINT8*>(data);
+	m_pending.push_back({ buffer, std::vector<UINT8>(src, src + size), finalState });
+	return buffer;
+}
+
+UINT64 StaticBufferUploader::Flush(ID3D12CommandQueue* queue)
+{
+	if (m_pending.empty())
+		return 0;
+
+	// One staging buffer holds every pending upload.
+	UINT64 totalSize = 0;
+	for (const auto& upload : m_pending)
+		totalSize += upload.data.size();
+
+	HRESULT hr;
+	hr = m_device->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(totalSize),
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(&m_stagingBuffer)
+	);
+	if (FAILED(hr))
+	{
+		throw std::runtime_error("Failed CreateCommittedResource(StaticBufferUploader staging)");
+	}
+
+	UINT8* mapped;
+	CD3DX12_RANGE range(0, 0);
+	hr = m_stagingBuffer->Map(0, &range, reinterpret_cast<void**>(&mapped));
+	if (FAILED(hr))
+	{
+		throw std::runtime_error("Failed Map(StaticBufferUploader staging)");
+	}
+
+	auto commandList = m_commandListPool->Acquire(D3D12_COMMAND_LIST_TYPE_DIRECT);
+
+	std::vector<ID3D12Resource*> buffers;
+	buffers.reserve(m_pending.size());
+	UINT64 offset = 0;
+	for (const auto& upload : m_pending)
+	{
+		const UINT64 size = upload.data.size();
+		memcpy(mapped + offset, upload.data.data(), size);
+		commandList->CopyBufferRegion(upload.buffer.Get(), 0, m_stagingBuffer.Get(), offset, size);
+		offset += size;
+
+		// The copy has promoted the buffer to COPY_DEST.
+		m_stateTracker->Register(upload.buffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST);
+		m_stateTracker->Transition(upload.buffer.Get(), upload.finalState);
+		buffers.push_back(upload.buffer.Get());
+	}
+	m_stagingBuffer->Unmap(0, nullptr);
+
+	// Go to the state to use after all copies.
+	m_stateTracker->Flush(commandList.commandList.Get(), buffers.data(), UINT(buffers.size()));
+	commandList->Close();
+
+	ID3D12CommandList* lists[] = { commandList.commandList.Get() };
+	queue->ExecuteCommandLists(1, lists);
+	const auto fenceValue = m_signal();
+	m_commandListPool->Release(commandList, fenceValue);
+	m_pending.clear();
+	return fenceValue;
+}
+
+void StaticBufferUploader::Reset()
+{
+	m_stagingBuffer.Reset();
+}
\ No newline at end of file
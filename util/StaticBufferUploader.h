@@ -0,0 +1,54 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <d3d12.h>
+
+#include "d3dx12.h"
+#include <wrl.h>
+#include <functional>
+#include <vector>
+#include "CommandListPool.h"
+#include "ResourceHeapAllocator.h"
+#include "ResourceStateTracker.h"
+
+// Uploads static geometry into DEFAULT heap buffers.
+// Requests are only recorded by Enqueue(), then Flush() copies all of them with one command list.
+class StaticBufferUploader {
+public:
+	template<class T>
+	using ComPtr = Microsoft::WRL::ComPtr<T>;
+	// Signal the next fence value on the queue and return it.
+	using SignalFunc = std::function<UINT64()>;
+
+	// Buffers are placed in the heaps of heapAllocator.
+	void Initialize(ID3D12Device* device, ResourceHeapAllocator* heapAllocator, ResourceStateTracker* stateTracker,
+		CommandListPool* commandListPool, SignalFunc signal);
+
+	// The returned buffer is usable after Flush() has been completed on GPU.
+	// It is placed at allocation, which the owner frees with the buffer after unregistering it from the tracker.
+	ComPtr<ID3D12Resource1> Enqueue(const void* data, UINT64 size, D3D12_RESOURCE_STATES finalState, HeapAllocation& allocation);
+
+	// Execute the copies of every pending request on the queue and return the fence value signaled after them,
+	// or 0 when nothing was pending. Caller must wait for it before Reset().
+	UINT64 Flush(ID3D12CommandQueue* queue);
+	// Release the staging memory of the last Flush().
+	void Reset();
+
+	bool IsEmpty() const { return m_pending.empty(); }
+
+private:
+	struct PendingUpload {
+		ComPtr<ID3D12Resource1> buffer;
+		std::vector<UINT8> data;
+		D3D12_RESOURCE_STATES finalState;
+	};
+
+	ComPtr<ID3D12Device> m_device;
+	ResourceHeapAllocator* m_heapAllocator = nullptr;
+	ResourceStateTracker* m_stateTracker = nullptr;
+	CommandListPool* m_commandListPool = nullptr;
+	SignalFunc m_signal;
+	ComPtr<ID3D12Resource> m_stagingBuffer;
+	std::vector<PendingUpload> m_pending;
+};
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include "TextureUploader.h"
+#include <algorithm>
+#include <stdexcept>
+
+void TextureUploader::Initialize(ID3D12Device* device, ID3D12CommandQueue* queue, SignalFunc signal,
+	DeferredReleaseQueue* releaseQueue, ResourceStateTracker* stateTracker, CommandListPool* commandListPool, UINT64 batchSize)
+{
+	m_device = device;
+	m_queue = queue;
+	m_signal = signal;
+	m_releaseQueue = releaseQueue;
+	m_stateTracker = stateTracker;
+	m_commandListPool = commandListPool;
+	m_batchSize = batchSize;
+}
+
+void TextureUploader::Enqueue(ID3D12Resource* texture, UINT firstSubresource, UINT numSubresources,
+	const D3D12_SUBRESOURCE_DATA* subresources, D3D12_RESOURCE_STATES finalState)
+{
+	if (!m_started)
+	{
+		m_startTime = std::chrono::steady_clock::now();
+		m_started = true;
+	}
+
+	auto desc = texture->GetDesc();
+	std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(numSubresources);
+	std::vector<UINT> numRows(numSubresources);
+	std::vector<UINT64> rowSizes(numSubresources);
+	UINT64 totalBytes = 0;
+	m_device->GetCopyableFootprints(&desc, firstSubresource, numSubresources, 0,
+		layouts.data(), numRows.data(), rowSizes.data(), &totalBytes);
+
+	// Close the batch when this texture doesn't fit in it.
+	if (m_openBatch)
+	{
+		const auto offset = (m_openBatch->used + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1) & ~UINT64(D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1);
+		if (offset + totalBytes > m_openBatch->capacity)
+			Submit();
+	}
+	if (!m_openBatch)
+	{
+		// A texture larger than the batch size gets its own batch.
+		OpenBatch(std::max(m_batchSize, totalBytes));
+	}
+
+	auto& batch = *m_openBatch;
+	const auto baseOffset = (batch.used + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1) & ~UINT64(D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1);
+	for (UINT i = 0; i < numSubresources; i++)
+	{
+		auto& layout = layouts[i];
+		layout.Offset += baseOffset;
+
+		// Copy the image to staging buffer.
+		D3D12_MEMCPY_DEST dst{
+			batch.mapped + layout.Offset,
+			layout.Footprint.RowPitch,
+			SIZE_T(layout.Footprint.RowPitch) * numRows[i]
+		};
+		MemcpySubresource(&dst, &subresources[i], SIZE_T(rowSizes[i]), numRows[i], layout.Footprint.Depth);
+
+		// Transferring command.
+		CD3DX12_TEXTURE_COPY_LOCATION dstLocation(texture, firstSubresource + i);
+		CD3DX12_TEXTURE_COPY_LOCATION srcLocation(batch.staging.Get(), layout);
+		batch.list->CopyTextureRegion(&dstLocation, 0, 0, 0, &srcLocation, nullptr);
+	}
+	batch.used = baseOffset + totalBytes;
+
+	m_stateTracker->Register(texture, D3D12_RESOURCE_STATE_COPY_DEST);
+	batch.transitions.push_back({ texture, firstSubresource, numSubresources, finalState });
+
+	m_stats.bytes += totalBytes;
+	m_stats.textures++;
+}
+
+UINT64 TextureUploader::Submit()
+{
+	if (!m_openBatch)
+		return 0;
+
+	auto batch = std::move(m_openBatch);
+	batch->staging->Unmap(0, nullptr);
+	batch->mapped = nullptr;
+
+	// Go to next state after copied, all textures at once.
+	std::vector<ID3D12Resource*> textures;
+	textures.reserve(batch->transitions.size());
+	for (const auto& transition : batch->transitions)
+	{
+		textures.push_back(transition.texture);
+		if (transition.firstSubresource == 0 && transition.numSubresources == m_stateTracker->GetSubresourceCount(transition.texture))
+		{
+			m_stateTracker->Transition(transition.texture, transition.finalState);
+			continue;
+		}
+		for (UINT i = 0; i < transition.numSubresources; i++)
+			m_stateTracker->Transition(transition.texture, transition.finalState, transition.firstSubresource + i);
+	}
+	// Barriers queued by the frame for other resources belong to the frame's list, not this batch.
+	m_stateTracker->Flush(batch->list.commandList.Get(), textures.data(), UINT(textures.size()));
+	batch->list->Close();
+
+	ID3D12CommandList* lists[] = { batch->list.commandList.Get() };
+	m_queue->ExecuteCommandLists(1, lists);
+	batch->fenceValue = m_signal();
+	m_commandListPool->Release(batch->list, batch->fenceValue);
+
+	// Release the staging memory of the whole batch in bulk after the copies.
+	m_releaseQueue->Enqueue(batch->fenceValue, std::move(batch->staging));
+
+	m_stats.batches++;
+	m_inflight.push_back(std::move(batch));
+	return m_inflight.back()->fenceValue;
+}
+
+void TextureUploader::Retire(UINT64 completedValue)
+{
+	bool retired = false;
+	while (!m_inflight.empty() && m_inflight.front()->fenceValue <= completedValue)
+	{
+		m_inflight.pop_front();
+		retired = true;
+	}
+
+	if (retired && m_started)
+	{
+		m_stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+	}
+}
+
+void TextureUploader::OpenBatch(UINT64 size)
+{
+	HRESULT hr;
+	auto batch = std::make_unique<Batch>();
+	batch->list = m_commandListPool->Acquire(D3D12_COMMAND_LIST_TYPE_DIRECT);
+
+	hr = m_device->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(size),
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(&batch->staging)
+	);
+	if (FAILED(hr))
+	{
+		throw std::runtime_error("Failed CreateCommittedResource(TextureUploader staging)");
+	}
+	CD3DX12_RANGE range(0, 0);
+	hr = batch->staging->Map(0, &range, reinterpret_cast<void**>(&batch->mapped));
+	if (FAILED(hr))
+	{
+		throw std::runtime_error("Failed Map(TextureUploader staging)");
+	}
+	batch->capacity = size;
+	batch->used = 0;
+	m_openBatch = std::move(batch);
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <d3d12.h>
+
+#include "d3dx12.h"
+#include <wrl.h>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "CommandListPool.h"
+#include "DeferredReleaseQueue.h"
+#include "ResourceStateTracker.h"
+
+struct TextureUploadStats {
+	UINT64 bytes = 0;
+	UINT64 textures = 0;
+	UINT64 batches = 0;
+	double seconds = 0.0; // From the first Enqueue() to the last completed batch.
+
+	double MegaBytesPerSecond() const { return seconds > 0.0 ? double(bytes) / (1024.0 * 1024.0) / seconds : 0.0; }
+	double BatchesPerSecond() const { return seconds > 0.0 ? double(batches) / seconds : 0.0; }
+};
+
+// Groups CopyTextureRegion of many textures into size bounded batches.
+// Each batch has one staging buffer and signals one fence value, and its staging buffer is handed to
+// the release queue to be freed at once when the value completes.
+class TextureUploader {
+public:
+	template<class T>
+	using ComPtr = Microsoft::WRL::ComPtr<T>;
+	// Signal the next fence value on the queue and return it.
+	using SignalFunc = std::function<UINT64()>;
+
+	void Initialize(ID3D12Device* device, ID3D12CommandQueue* queue, SignalFunc signal,
+		DeferredReleaseQueue* releaseQueue, ResourceStateTracker* stateTracker, CommandListPool* commandListPool,
+		UINT64 batchSize = 64 * 1024 * 1024);
+
+	// The texture must be in COPY_DEST state, and is registered to the state tracker as such.
+	// It goes to finalState after copy.
+	void Enqueue(ID3D12Resource* texture, UINT firstSubresource, UINT numSubresources,
+		const D3D12_SUBRESOURCE_DATA* subresources, D3D12_RESOURCE_STATES finalState);
+
+	// Submit the open batch. Return the fence value of it, or 0 when nothing was submitted.
+	UINT64 Submit();
+	// Forget the completed batches. Their command lists are recycled by the pool.
+	void Retire(UINT64 completedValue);
+
+	bool IsIdle() const { return !m_openBatch && m_inflight.empty(); }
+	const TextureUploadStats& GetStats() const { return m_stats; }
+	void ResetStats() { m_stats = TextureUploadStats(); m_started = false; }
+
+private:
+	struct Batch {
+		PooledCommandList list;
+		ComPtr<ID3D12Resource> staging;
+		UINT8* mapped = nullptr;
+		UINT64 capacity = 0;
+		UINT64 used = 0;
+		UINT64 fenceValue = 0;
+		struct Transition {
+			ID3D12Resource* texture;
+			UINT firstSubresource;
+			UINT numSubresources;
+			D3D12_RESOURCE_STATES finalState;
+		};
+		std::vector<Transition> transitions;
+	};
+	using BatchPtr = std::unique_ptr<Batch>;
+
+	void OpenBatch(UINT64 size);
+
+	ComPtr<ID3D12Device> m_device;
+	ComPtr<ID3D12CommandQueue> m_queue;
+	SignalFunc m_signal;
+	DeferredReleaseQueue* m_releaseQueue = nullptr;
+	ResourceStateTracker* m_stateTracker = nullptr;
+	CommandListPool* m_commandListPool = nullptr;
+	UINT64 m_batchSize = 0;
+
+	BatchPtr m_openBatch;
+	std::deque<BatchPtr> m_inflight;
+
+	TextureUploadStats m_stats;
+	bool m_started = false;
+	std::chrono::steady_clock::time_point m_startTime;
+};
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include "UploadRingBuffer.h"
+#include <stdexcept>
+
+UploadRingBuffer::~UploadRingBuffer()
+{
+	if (m_buffer && m_mapped)
+	{
+		m_buffer->Unmap(0, nullptr);
+	}
+}
+
+void UploadRingBuffer::Initialize(ID3D12Device* device, UINT64 size)
+{
+	HRESULT hr;
+	hr = device->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(size),
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(&m_buffer)
+	);
+	if (FAILED(hr))
+	{
+		throw std::runtime_error("Failed CreateCommittedResource(UploadRingBuffer)");
+	}
+
+	// Keep mapped during the lifetime. Upload heap is write-combined, so CPU never reads it.
+	CD3DX12_RANGE range(0, 0);
+	hr = m_buffer->Map(0, &range, reinterpret_cast<void**>(&m_mapped));
+	if (FAILED(hr))
+	{
+		throw std::runtime_error("Failed Map(UploadRingBuffer)");
+	}
+	m_gpuAddress = m_buffer->GetGPUVirtualAddress();
+	m_ring.Reset(size);
+}
+
+bool UploadRingBuffer::Allocate(UINT64 size, UINT64 alignment, UploadAllocation& allocation)
+{
+	UINT64 offset;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		offset = m_ring.Allocate(size, alignment);
+	}
+	if (offset == RingAllocator::InvalidOffset)
+		return false;
+
+	allocation.cpuAddress = m_mapped + offset;
+	allocation.gpuAddress = m_gpuAddress + offset;
+	allocation.resource = m_buffer.Get();
+	allocation.offset = offset;
+	return true;
+}
+
+bool UploadRingBuffer::Upload(const void* data, UINT64 size, UINT64 alignment, UploadAllocation& allocation)
+{
+	if (!Allocate(size, alignment, allocation))
+		return false;
+	memcpy(allocation.cpuAddress, data, size);
+	return true;
+}
\ No newline at end of file
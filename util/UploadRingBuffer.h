@@ -0,0 +1,49 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <d3d12.h>
+
+#include "d3dx12.h"
+#include <wrl.h>
+#include "RingAllocator.h"
+#include <mutex>
+
+// Sub allocation of UploadRingBuffer. It is valid until the fence value of the frame completes.
+struct UploadAllocation {
+	void* cpuAddress = nullptr;
+	D3D12_GPU_VIRTUAL_ADDRESS gpuAddress = 0;
+	ID3D12Resource* resource = nullptr;
+	UINT64 offset = 0;
+};
+
+// Persistently mapped UPLOAD heap buffer handing out aligned transient regions per frame.
+class UploadRingBuffer {
+public:
+	template<class T>
+	using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+	UploadRingBuffer() : m_mapped(nullptr), m_gpuAddress(0) {}
+	~UploadRingBuffer();
+
+	void Initialize(ID3D12Device* device, UINT64 size);
+
+	// Return false when the ring is full. Caller may fall back to a committed buffer.
+	// Allocate() and Upload() may be called from recording threads; the rest only from the render thread.
+	bool Allocate(UINT64 size, UINT64 alignment, UploadAllocation& allocation);
+	bool Upload(const void* data, UINT64 size, UINT64 alignment, UploadAllocation& allocation);
+
+	void FinishFrame(UINT64 fenceValue) { m_ring.FinishFrame(fenceValue); }
+	void Retire(UINT64 completedValue) { m_ring.Retire(completedValue); }
+
+	ID3D12Resource* GetResource() const { return m_buffer.Get(); }
+	UINT64 GetSize() const { return m_ring.GetSize(); }
+	UINT64 GetUsedSize() const { return m_ring.GetUsedSize(); }
+
+private:
+	ComPtr<ID3D12Resource> m_buffer;
+	UINT8* m_mapped;
+	D3D12_GPU_VIRTUAL_ADDRESS m_gpuAddress;
+	RingAllocator m_ring;
+	std::mutex m_mutex;
+};
\ No newline at end of file
@@ -9,4 +9,13 @@ using Vector4 = DirectX::XMFLOAT4;
 
 // Matrices
 using Matrix3x3 = DirectX::XMFLOAT3X3;
-using Matrix4x4 = DirectX::XMFLOAT4X4;
\ No newline at end of file
+using Matrix4x4 = DirectX::XMFLOAT4X4;
+
+// dst[i] = src[i] * m for count matrices, with m kept in registers over the batch.
+inline void MultiplyMatrices(const Matrix4x4* src, size_t count, DirectX::FXMMATRIX m, Matrix4x4* dst)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		DirectX::XMStoreFloat4x4(&dst[i], DirectX::XMMatrixMultiply(DirectX::XMLoadFloat4x4(&src[i]), m));
+	}
+}
\ No newline at end of file